@@ -0,0 +1,179 @@
+//Vertex welding microbenchmark: std::unordered_map (the old loadModel() dedup) against VertexWelder and weldVerticesParallel
+//Usage: ./weldBenchmark [model.obj] [synthetic index count]
+
+#include <vulkan/vulkan.h>
+
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtx/hash.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <array>
+#include <optional>
+#include <unordered_map>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <filesystem>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "../headers/structs.h"
+#include "../headers/mappedFile.h"
+#include "../headers/hash.h"
+#include "../headers/objParser.h"
+#include "../headers/vertexWelder.h"
+
+struct WeldResult {
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+};
+
+//Exactly what loadModel() did before: count() followed by operator[]
+template<typename GetVertex>
+WeldResult weldUnorderedMap(size_t count, GetVertex getVertex) {
+	WeldResult result;
+	std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+	result.indices.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		Vertex vertex = getVertex(i);
+		if (uniqueVertices.count(vertex) == 0) {
+			uniqueVertices[vertex] = static_cast<uint32_t>(result.vertices.size());
+			result.vertices.push_back(vertex);
+		}
+		result.indices.push_back(uniqueVertices[vertex]);
+	}
+	return result;
+}
+
+template<typename GetVertex>
+WeldResult weldSerial(size_t count, GetVertex getVertex) {
+	WeldResult result;
+	VertexWelder welder(result.vertices);
+	result.indices.reserve(count);
+	for (size_t i = 0; i < count; i++) { result.indices.push_back(welder.weld(getVertex(i))); }
+	return result;
+}
+
+template<typename GetVertex>
+WeldResult weldParallel(size_t count, GetVertex getVertex, unsigned int threadCount) {
+	WeldResult result;
+	weldVerticesParallel(count, getVertex, threadCount, result.vertices, result.indices);
+	return result;
+}
+
+bool sameResult(const WeldResult& a, const WeldResult& b) {
+	return a.indices == b.indices && a.vertices.size() == b.vertices.size() &&
+		std::equal(a.vertices.begin(), a.vertices.end(), b.vertices.begin());
+}
+
+//Best of several runs, checked against the unordered_map output
+template<typename Weld>
+void runCase(const std::string& name, size_t count, int repeats, const WeldResult& reference, double referenceMilliseconds, Weld weld) {
+	double best = std::numeric_limits<double>::max();
+	WeldResult result;
+	for (int i = 0; i < repeats; i++) {
+		auto startTime = std::chrono::high_resolution_clock::now();
+		result = weld();
+		auto endTime = std::chrono::high_resolution_clock::now();
+		best = std::min(best, std::chrono::duration<double, std::milli>(endTime - startTime).count());
+	}
+	std::cout << "  " << name << ": " << best << " ms, " << count / best / 1000.0 << " M indices/s, "
+		<< referenceMilliseconds / best << "x" << (sameResult(result, reference) ? "" : " MISMATCH") << std::endl;
+}
+
+template<typename GetVertex>
+void benchmark(const std::string& title, size_t count, int repeats, GetVertex getVertex) {
+	auto startTime = std::chrono::high_resolution_clock::now();
+	WeldResult reference = weldUnorderedMap(count, getVertex);
+	auto endTime = std::chrono::high_resolution_clock::now();
+	double referenceMilliseconds = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	for (int i = 1; i < repeats; i++) {
+		startTime = std::chrono::high_resolution_clock::now();
+		WeldResult again = weldUnorderedMap(count, getVertex);
+		endTime = std::chrono::high_resolution_clock::now();
+		referenceMilliseconds = std::min(referenceMilliseconds, std::chrono::duration<double, std::milli>(endTime - startTime).count());
+	}
+
+	std::cout << title << ": " << count << " indices, " << reference.vertices.size() << " unique vertices" << std::endl;
+	std::cout << "  unordered_map: " << referenceMilliseconds << " ms, " << count / referenceMilliseconds / 1000.0 << " M indices/s" << std::endl;
+	runCase("VertexWelder", count, repeats, reference, referenceMilliseconds, [&]() { return weldSerial(count, getVertex); });
+
+	unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned int threads = 1; threads < hardwareThreads * 2; threads *= 2) {
+		unsigned int threadCount = std::min(threads, hardwareThreads);
+		runCase("weldVerticesParallel " + std::to_string(threadCount) + " threads", count, repeats, reference, referenceMilliseconds,
+			[&]() { return weldParallel(count, getVertex, threadCount); });
+	}
+}
+
+int main(int argc, char* argv[]) {
+	try {
+		std::string modelPath = argc > 1 ? argv[1] : "models/viking_room.obj";
+		size_t syntheticCount = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 50000000;
+
+		//Real mesh: corners straight from the OBJ, welded the way loadModel() does
+		struct CornerSink {
+			std::vector<float> positions, texcoords;
+			std::vector<ObjCorner> corners;
+
+			void position(float x, float y, float z) { positions.insert(positions.end(), {x, y, z}); }
+			void texcoord(float u, float v) { texcoords.insert(texcoords.end(), {u, v}); }
+			void corner(ObjCorner corner) {
+				bool relative = false;
+				corner.position = resolveObjIndex(corner.position, positions.size() / 3, relative);
+				if (corner.hasTexcoord) { corner.texcoord = resolveObjIndex(corner.texcoord, texcoords.size() / 2, relative); }
+				checkObjCorner(positions, texcoords, corner);
+				corners.push_back(corner);
+			}
+		};
+		CornerSink model;
+		{
+			MappedFile file(modelPath);
+			parseObjLines(file.data(), file.data() + file.size(), model);
+		}
+		benchmark(modelPath, model.corners.size(), 20, [&model](size_t i) { return makeObjVertex(model.positions, model.texcoords, model.corners[i]); });
+
+		//Synthetic mesh: a square grid of quads, two triangles each. Every interior vertex is shared by six corners like a typical closed mesh
+		size_t side = std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(syntheticCount) / 6.0)));
+		size_t quadCount = syntheticCount / 6;
+		auto gridVertex = [side](size_t i) {
+			static const size_t cornerX[6] = {0, 1, 1, 0, 1, 0};
+			static const size_t cornerY[6] = {0, 0, 1, 0, 1, 1};
+			size_t quad = i / 6;
+			size_t x = quad % side + cornerX[i % 6];
+			size_t y = quad / side + cornerY[i % 6];
+
+			Vertex vertex{};
+			vertex.pos = {static_cast<float>(x) * 0.01f, static_cast<float>(y) * 0.01f, std::sin(static_cast<float>(x + y) * 0.1f)};
+			vertex.color = {1.0f, 1.0f, 1.0f};
+			vertex.texCoord = {static_cast<float>(x) / static_cast<float>(side), static_cast<float>(y) / static_cast<float>(side)};
+			return vertex;
+		};
+		benchmark("synthetic grid", quadCount * 6, 1, gridVertex);
+	} catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+//Worker threads that decode assets off the main thread. A job runs on a worker and returns a completion, completions are queued and run on the
+//main thread by runCompletions() because everything touching Vulkan, like the staging ring, is single threaded
+class AssetLoader {
+public:
+	using Completion = std::function<void()>;
+	using Job = std::function<Completion()>;
+
+	explicit AssetLoader(unsigned int threadCount) {
+		for (unsigned int i = 0; i < std::max(1u, threadCount); i++) { workers.emplace_back([this]() { work(); }); }
+	}
+
+	//Jobs that have not started yet are dropped, running ones are finished
+	~AssetLoader() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+			pending -= jobs.size();
+			jobs.clear();
+		}
+		jobAvailable.notify_all();
+		for (auto& worker : workers) { worker.join(); }
+	}
+
+	AssetLoader(const AssetLoader&) = delete;
+	AssetLoader& operator=(const AssetLoader&) = delete;
+
+	void submit(Job job) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobs.push_back(std::move(job));
+			pending++;
+		}
+		jobAvailable.notify_one();
+	}
+
+	//Runs the queued completions on the calling thread. An exception thrown by a job is rethrown here
+	size_t runCompletions() {
+		std::vector<Completion> ready;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			ready.swap(completions);
+		}
+		for (Completion& completion : ready) { completion(); }
+		return ready.size();
+	}
+
+	//Blocks until a completion is queued, returns right away if there is one or no job is left
+	void waitForCompletion() {
+		std::unique_lock<std::mutex> lock(mutex);
+		completionAvailable.wait(lock, [this]() { return !completions.empty() || pending == 0; });
+	}
+
+	//No job queued or running
+	bool idle() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return pending == 0;
+	}
+
+private:
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable jobAvailable;
+	std::condition_variable completionAvailable;
+	std::deque<Job> jobs;
+	std::vector<Completion> completions;
+	size_t pending = 0; //Queued or running
+	bool stopping = false;
+
+	void work() {
+		for (;;) {
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+				if (jobs.empty()) { return; }
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+
+			Completion completion;
+			try { completion = job(); }
+			catch (...) {
+				std::exception_ptr error = std::current_exception();
+				completion = [error]() { std::rethrow_exception(error); };
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (completion) { completions.push_back(std::move(completion)); }
+				pending--;
+			}
+			completionAvailable.notify_all();
+		}
+	}
+};
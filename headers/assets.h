@@ -0,0 +1,145 @@
+//Asset loading (ASYNC_ASSET_LOADING). The model and the texture are decoded on assetLoader's workers while the first frames draw a placeholder cube,
+//their completions upload on the main thread and the assets are swapped in once those uploads are complete. Until the model is published the loader
+//job owns every model member (vertices, indices, lods, index ranges, meshlets), recordCommandBuffer() must not read them
+void startAssetLoading() {
+	assetLoader = std::make_unique<AssetLoader>(ASSET_LOADER_THREADS);
+
+	assetLoader->submit([this]() {
+		loadModel();
+		createLods();
+		createIndexRanges();
+		createMeshlets();
+		return AssetLoader::Completion([this]() {
+			createVertexBuffer();
+			createIndexBuffer();
+			createInstanceBuffer();
+			modelUpload = flushUploads();
+		});
+	});
+
+	assetLoader->submit([this]() {
+		TraceScope traceScope("decodeTexture", "assets");
+		int texWidth, texHeight, texChannels;
+		std::shared_ptr<stbi_uc> pixels(stbi_load(TEXTURE_PATH.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha), stbi_image_free);
+		if (!pixels) { throw std::runtime_error("failed to load texture image!"); }
+		return AssetLoader::Completion([this, pixels, texWidth, texHeight]() {
+			createTextureImage(pixels.get(), texWidth, texHeight);
+			createTextureImageView();
+			textureUpload = flushUploads();
+		});
+	});
+}
+
+//Called once per frame: runs finished decodes and publishes assets whose uploads are complete, never blocks
+void updateAssets() {
+	if (!assetLoader) { return; }
+	assetLoader->runCompletions();
+
+	if (modelUpload && isUploadComplete(*modelUpload)) {
+		modelUpload.reset();
+		modelResident = true;
+		std::cout << "Model resident after " << millisecondsSinceStartup() << " ms" << std::endl;
+	}
+	if (textureUpload && isUploadComplete(*textureUpload)) {
+		textureUpload.reset();
+		textureResident = true;
+		std::fill(descriptorSetsStale.begin(), descriptorSetsStale.end(), true);
+		std::cout << "Texture resident after " << millisecondsSinceStartup() << " ms" << std::endl;
+	}
+
+	if (modelResident && textureResident) {
+		assetLoader.reset();
+		std::cout << "All assets resident after " << millisecondsSinceStartup() << " ms" << std::endl;
+	}
+}
+
+//Blocking load, used when the assets are needed before the first frame
+void waitForAssets() {
+	while (assetLoader) {
+		assetLoader->waitForCompletion();
+		assetLoader->runCompletions();
+		if (modelUpload) { waitForUpload(*modelUpload); }
+		if (textureUpload) { waitForUpload(*textureUpload); }
+		updateAssets();
+	}
+}
+
+double millisecondsSinceStartup() {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startupTime).count();
+}
+
+//Unit cube with a grey checkerboard, drawn in place of the model and bound in place of the texture until they are resident
+void createPlaceholderAssets() {
+	if (!ASYNC_ASSET_LOADING) { return; }
+
+	std::vector<Vertex> cubeVertices;
+	std::vector<uint16_t> cubeIndices;
+	for (int face = 0; face < 6; face++) {
+		int axis = face / 2;
+		float sign = face % 2 == 0 ? 1.0f : -1.0f;
+		glm::vec3 normal(0.0f), tangent(0.0f), bitangent(0.0f);
+		normal[axis] = sign;
+		tangent[(axis + 1) % 3] = 1.0f;
+		bitangent[(axis + 2) % 3] = 1.0f;
+
+		uint16_t base = static_cast<uint16_t>(cubeVertices.size());
+		for (int corner = 0; corner < 4; corner++) {
+			float s = static_cast<float>(corner & 1), t = static_cast<float>(corner >> 1);
+			Vertex vertex{};
+				vertex.pos = (normal + tangent * (s * 2.0f - 1.0f) + bitangent * (t * 2.0f - 1.0f)) * 0.5f;
+				vertex.color = {1.0f, 1.0f, 1.0f};
+				vertex.texCoord = {s, t};
+			cubeVertices.push_back(vertex);
+		}
+		//Counter clockwise seen from outside, tangent x bitangent points along +axis
+		std::array<uint16_t, 6> quad = sign > 0.0f ? std::array<uint16_t, 6>{0, 1, 3, 0, 3, 2} : std::array<uint16_t, 6>{0, 3, 1, 0, 2, 3};
+		for (uint16_t index : quad) { cubeIndices.push_back(base + index); }
+	}
+	placeholderIndexCount = static_cast<uint32_t>(cubeIndices.size());
+
+	VkDeviceSize vertexBufferSize = sizeof(cubeVertices[0]) * cubeVertices.size();
+	const void* vertexData = cubeVertices.data();
+	std::vector<QuantizedVertex> quantizedVertices;
+	if (VERTEX_FORMAT == VertexFormat::Quantized) {
+		placeholderQuantization = computeVertexQuantization(cubeVertices);
+		quantizedVertices = quantizeVertices(cubeVertices, placeholderQuantization);
+		vertexBufferSize = sizeof(quantizedVertices[0]) * quantizedVertices.size();
+		vertexData = quantizedVertices.data();
+	}
+	createBuffer(vertexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, placeholderVertexBuffer, placeholderVertexBufferMemory);
+	uploadToBuffer(placeholderVertexBuffer, 0, vertexData, vertexBufferSize);
+
+	VkDeviceSize indexBufferSize = sizeof(cubeIndices[0]) * cubeIndices.size();
+	createBuffer(indexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, placeholderIndexBuffer, placeholderIndexBufferMemory);
+	uploadToBuffer(placeholderIndexBuffer, 0, cubeIndices.data(), indexBufferSize);
+
+	//4x4 checkerboard, one mip level
+	const uint32_t size = 4;
+	std::vector<uint8_t> pixels(size * size * 4);
+	for (uint32_t i = 0; i < size * size; i++) {
+		uint8_t value = ((i % size) + (i / size)) % 2 == 0 ? 96 : 160;
+		pixels[i * 4 + 0] = value;
+		pixels[i * 4 + 1] = value;
+		pixels[i * 4 + 2] = value;
+		pixels[i * 4 + 3] = 255;
+	}
+	createImage(size, size, 1, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, placeholderImage, placeholderImageMemory);
+	transitionImageLayout(placeholderImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1);
+	uploadToImage(placeholderImage, size, size, 4, pixels.data());
+	transferImageOwnership(placeholderImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1);
+	transitionImageLayout(placeholderImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1);
+	placeholderImageView = createImageView(placeholderImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+}
+
+//Drops the placeholder through the deletion queue once nothing draws or binds it anymore, or at cleanup
+void unloadPlaceholderAssets(bool force = true) {
+	if (placeholderImage == VK_NULL_HANDLE) { return; }
+	bool inUse = !modelResident || !textureResident || std::find(descriptorSetsStale.begin(), descriptorSetsStale.end(), true) != descriptorSetsStale.end();
+	if (inUse && !force) { return; }
+
+	deferDestroyImageView(placeholderImageView);
+	deferDestroyImage(placeholderImage, placeholderImageMemory);
+	deferDestroyBuffer(placeholderIndexBuffer, placeholderIndexBufferMemory);
+	deferDestroyBuffer(placeholderVertexBuffer, placeholderVertexBufferMemory);
+	placeholderImage = VK_NULL_HANDLE;
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+//Named series of millisecond samples for the benchmark report, in the order they were first added. Percentiles are nearest rank on the sorted
+//samples, the histogram splits min to max into equal bins
+struct SampleSummary {
+	size_t count = 0;
+	double min = 0.0;
+	double mean = 0.0;
+	double p50 = 0.0;
+	double p95 = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+	double binWidth = 0.0;
+	std::vector<uint32_t> histogram;
+};
+
+class BenchmarkStatistics {
+public:
+	void add(const std::string& series, double milliseconds) {
+		auto found = std::find_if(samples.begin(), samples.end(), [&series](const auto& entry) { return entry.first == series; });
+		if (found == samples.end()) { found = samples.insert(samples.end(), {series, {}}); }
+		found->second.push_back(milliseconds);
+	}
+
+	void clear() { samples.clear(); }
+
+	std::vector<std::string> seriesNames() const {
+		std::vector<std::string> names;
+		for (const auto& entry : samples) { names.push_back(entry.first); }
+		return names;
+	}
+
+	SampleSummary summarize(const std::string& series, uint32_t histogramBins) const {
+		SampleSummary summary;
+		auto found = std::find_if(samples.begin(), samples.end(), [&series](const auto& entry) { return entry.first == series; });
+		if (found == samples.end() || found->second.empty()) { return summary; }
+
+		std::vector<double> sorted = found->second;
+		std::sort(sorted.begin(), sorted.end());
+		summary.count = sorted.size();
+		summary.min = sorted.front();
+		summary.max = sorted.back();
+		double sum = 0.0;
+		for (double sample : sorted) { sum += sample; }
+		summary.mean = sum / sorted.size();
+		summary.p50 = percentile(sorted, 50.0);
+		summary.p95 = percentile(sorted, 95.0);
+		summary.p99 = percentile(sorted, 99.0);
+
+		summary.histogram.assign(std::max(1u, histogramBins), 0);
+		summary.binWidth = (summary.max - summary.min) / summary.histogram.size();
+		for (double sample : sorted) {
+			size_t bin = summary.binWidth > 0.0 ? static_cast<size_t>((sample - summary.min) / summary.binWidth) : 0;
+			summary.histogram[std::min(bin, summary.histogram.size() - 1)]++; //max lands on the upper edge of the last bin
+		}
+		return summary;
+	}
+
+	//properties are written as strings at the top level, next to one object per series
+	void writeJson(const std::string& path, const std::vector<std::pair<std::string, std::string>>& properties, uint32_t histogramBins) const {
+		std::ofstream file(path, std::ios::trunc);
+		if (!file) { throw std::runtime_error("failed to open benchmark output " + path + "!"); }
+
+		file << std::setprecision(6) << "{\n";
+		for (const auto& property : properties) { file << "\t\"" << escapeJson(property.first) << "\": \"" << escapeJson(property.second) << "\",\n"; }
+		file << "\t\"series\": {";
+		for (size_t i = 0; i < samples.size(); i++) {
+			SampleSummary summary = summarize(samples[i].first, histogramBins);
+			file << (i == 0 ? "\n" : ",\n") << "\t\t\"" << escapeJson(samples[i].first) << "\": {\"count\": " << summary.count << ", \"min\": " << summary.min
+				<< ", \"mean\": " << summary.mean << ", \"p50\": " << summary.p50 << ", \"p95\": " << summary.p95 << ", \"p99\": " << summary.p99
+				<< ", \"max\": " << summary.max << ", \"histogram\": {\"start\": " << summary.min << ", \"binWidth\": " << summary.binWidth << ", \"counts\": [";
+			for (size_t bin = 0; bin < summary.histogram.size(); bin++) { file << (bin == 0 ? "" : ", ") << summary.histogram[bin]; }
+			file << "]}}";
+		}
+		file << "\n\t}\n}\n";
+		if (!file) { throw std::runtime_error("failed to write benchmark output " + path + "!"); }
+	}
+
+	//One row per series, the histogram is only in the JSON
+	void writeCsv(const std::string& path) const {
+		std::ofstream file(path, std::ios::trunc);
+		if (!file) { throw std::runtime_error("failed to open benchmark output " + path + "!"); }
+
+		file << std::setprecision(6) << "series,count,min,mean,p50,p95,p99,max\n";
+		for (const auto& entry : samples) {
+			SampleSummary summary = summarize(entry.first, 1);
+			file << entry.first << "," << summary.count << "," << summary.min << "," << summary.mean << "," << summary.p50 << ","
+				<< summary.p95 << "," << summary.p99 << "," << summary.max << "\n";
+		}
+		if (!file) { throw std::runtime_error("failed to write benchmark output " + path + "!"); }
+	}
+
+private:
+	std::vector<std::pair<std::string, std::vector<double>>> samples;
+
+	static double percentile(const std::vector<double>& sorted, double percent) {
+		size_t rank = static_cast<size_t>(std::ceil(percent / 100.0 * sorted.size()));
+		return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+	}
+
+	static std::string escapeJson(const std::string& text) {
+		std::string escaped;
+		for (char c : text) {
+			if (c == '"' || c == '\\') { escaped += '\\'; escaped += c; }
+			else if (static_cast<unsigned char>(c) < 0x20) { escaped += ' '; }
+			else { escaped += c; }
+		}
+		return escaped;
+	}
+};
\ No newline at end of file
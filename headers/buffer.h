@@ -3,7 +3,7 @@ void createBuffer(
 	VkBufferUsageFlags usage,
 	VkMemoryPropertyFlags properties,
 	VkBuffer& buffer,
-	VkDeviceMemory& bufferMemory
+	MemoryAllocation& bufferMemory
 	) {
 	VkBufferCreateInfo bufferInfo{};
 		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -17,75 +17,103 @@ void createBuffer(
 	VkMemoryRequirements memRequirements;
 	vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
 
-	//Memory Allocation
-	VkMemoryAllocateInfo memoryAllocInfo{};
-		memoryAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		memoryAllocInfo.allocationSize = memRequirements.size;
-		memoryAllocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-	if (vkAllocateMemory(device, &memoryAllocInfo, nullptr, &bufferMemory) != VK_SUCCESS) { throw std::runtime_error("failed to allocate buffer memory!"); }
-	vkBindBufferMemory(device, buffer, bufferMemory, 0);
+	//Memory Allocation, a range of a shared block
+	bufferMemory = memoryAllocator->allocate(memRequirements, findMemoryType(memRequirements.memoryTypeBits, properties), false);
+	vkBindBufferMemory(device, buffer, bufferMemory.memory, bufferMemory.offset);
+}
+
+void destroyBuffer(VkBuffer buffer, MemoryAllocation& bufferMemory) {
+	vkDestroyBuffer(device, buffer, nullptr);
+	memoryAllocator->free(bufferMemory);
 }
 
 void createVertexBuffer() {
 	VkDeviceSize vertexBufferSize = sizeof(vertices[0]) * vertices.size();
-
-	VkBuffer vertexStagingBuffer;
-	VkDeviceMemory vertexStagingBufferMemory;
-
-	//CPU visible buffer
-	createBuffer(vertexBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, vertexStagingBuffer, vertexStagingBufferMemory);
-
-	//Filling the Vertex Buffer
-	void* data;
-	vkMapMemory(device, vertexStagingBufferMemory, 0, vertexBufferSize, 0, &data);
-	memcpy(data, vertices.data(), (size_t) vertexBufferSize);
-	vkUnmapMemory(device, vertexStagingBufferMemory);
+	const void* vertexData = vertices.data();
+
+	//The CPU side keeps the full Vertex array, the quantized copy only lives for the upload
+	std::vector<QuantizedVertex> quantizedVertices;
+	if (VERTEX_FORMAT == VertexFormat::Quantized) {
+		vertexQuantization = computeVertexQuantization(vertices);
+		quantizedVertices = quantizeVertices(vertices, vertexQuantization);
+		vertexBufferSize = sizeof(quantizedVertices[0]) * quantizedVertices.size();
+		vertexData = quantizedVertices.data();
+
+		QuantizationError error = measureQuantizationError(vertices, quantizedVertices, vertexQuantization);
+		std::cout << "Quantized vertices: " << sizeof(Vertex) << " -> " << sizeof(QuantizedVertex) << " bytes, position error max " << error.maxPositionError
+			<< " mean " << error.meanPositionError << " (" << error.maxPositionError / error.boundsDiagonal * 100.0f << "% of bounds diagonal), UV error max "
+			<< error.maxTexCoordError << " mean " << error.meanTexCoordError << std::endl;
+	}
 
 	//GPU local buffer
 	createBuffer(vertexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
 
-	//Transfer from CPU to GPU buffer
-	copyBuffer(vertexStagingBuffer, vertexBuffer, vertexBufferSize);
+	//Transfer from CPU to GPU buffer through the staging ring
+	uploadToBuffer(vertexBuffer, 0, vertexData, vertexBufferSize);
+}
+
+//Picks the index type before the buffers are created. Splitting a large mesh into 16-bit ranges can duplicate vertices, so this has to run before createVertexBuffer()
+void createIndexRanges() {
+	if (!ALLOW_16BIT_INDICES) {
+		indexType = VK_INDEX_TYPE_UINT32;
+		indexRanges = {{0, static_cast<uint32_t>(indices.size()), 0}};
+		return;
+	}
+	if (vertices.size() <= 65536) {
+		indexType = VK_INDEX_TYPE_UINT16;
+		indexRanges = {{0, static_cast<uint32_t>(indices.size()), 0}};
+		return;
+	}
+
+	std::vector<Vertex> splitVertices = vertices;
+	std::vector<uint32_t> splitIndices = indices;
+	std::vector<IndexRange> splitRanges = splitIndexRanges16(splitVertices, splitIndices);
+
+	//Keep 32-bit indices if the duplicated vertices would cost more memory than the smaller indices save
+	size_t duplicated = splitVertices.size() - vertices.size();
+	size_t vertexStride = VERTEX_FORMAT == VertexFormat::Quantized ? sizeof(QuantizedVertex) : sizeof(Vertex);
+	if (duplicated * vertexStride >= indices.size() * (sizeof(uint32_t) - sizeof(uint16_t))) {
+		std::cout << "Keeping 32-bit indices, 16-bit ranges would duplicate " << duplicated << " vertices" << std::endl;
+		indexType = VK_INDEX_TYPE_UINT32;
+		indexRanges = {{0, static_cast<uint32_t>(indices.size()), 0}};
+		return;
+	}
 
-	//Cleanup
-	vkDestroyBuffer(device, vertexStagingBuffer, nullptr);
-	vkFreeMemory(device, vertexStagingBufferMemory, nullptr);
+	if (splitRanges.size() > 1) { std::cout << "Split mesh into " << splitRanges.size() << " 16-bit index ranges, " << duplicated << " vertices duplicated" << std::endl; }
+	vertices.swap(splitVertices);
+	indices.swap(splitIndices);
+	indexType = VK_INDEX_TYPE_UINT16;
+	indexRanges = splitRanges;
 }
 
 void createIndexBuffer() {
 	VkDeviceSize indexBufferSize = sizeof(indices[0]) * indices.size();
+	const void* indexSource = indices.data();
 
-	VkBuffer indexStagingBuffer;
-	VkDeviceMemory indexStagingBufferMemory;
-
-	//CPU visible buffer
-	createBuffer(indexBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, indexStagingBuffer, indexStagingBufferMemory);
-
-	//Filling the Index Buffer
-	void* indexData;
-	vkMapMemory(device, indexStagingBufferMemory, 0, indexBufferSize, 0, &indexData);
-	memcpy(indexData, indices.data(), (size_t) indexBufferSize);
-	vkUnmapMemory(device, indexStagingBufferMemory);
+	std::vector<uint16_t> indices16;
+	if (indexType == VK_INDEX_TYPE_UINT16) {
+		indices16 = packIndices16(indices, indexRanges);
+		indexBufferSize = sizeof(indices16[0]) * indices16.size();
+		indexSource = indices16.data();
+	}
+	std::cout << "Index buffer: " << (indexType == VK_INDEX_TYPE_UINT16 ? "uint16" : "uint32") << ", " << indexRanges.size() << " draw ranges, "
+		<< indexBufferSize / 1024.0 << " KB" << std::endl;
 
 	//GPU local buffer
 	createBuffer(indexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
 
-	//Transfer from CPU to GPU buffer
-	copyBuffer(indexStagingBuffer, indexBuffer, indexBufferSize);
-
-	//Cleanup
-	vkDestroyBuffer(device, indexStagingBuffer, nullptr);
-	vkFreeMemory(device, indexStagingBufferMemory, nullptr);
+	//Transfer from CPU to GPU buffer through the staging ring
+	uploadToBuffer(indexBuffer, 0, indexSource, indexBufferSize);
 }
 
 void createUniformBuffer() {
 	VkDeviceSize uniformBufferSize = sizeof(UniformBufferObject);
 
-	uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-	uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-	uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+	uniformBuffers.resize(framesInFlight);
+	uniformBuffersMemory.resize(framesInFlight);
+	uniformBuffersMapped.resize(framesInFlight);
 
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+	for (size_t i = 0; i < framesInFlight; i++) {
 		createBuffer(
 			uniformBufferSize,
 			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
@@ -93,14 +121,6 @@ void createUniformBuffer() {
 			uniformBuffers[i],
 			uniformBuffersMemory[i]
 			);
-		vkMapMemory(device, uniformBuffersMemory[i], 0, uniformBufferSize, 0, &uniformBuffersMapped[i]);
+		uniformBuffersMapped[i] = uniformBuffersMemory[i].mapped;
 	}
-}
-
-void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
-	VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-	VkBufferCopy copyRegion{};
-			copyRegion.size = size;
-	vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-	endSingleTimeCommands(commandBuffer);
 }
\ No newline at end of file
@@ -7,53 +7,81 @@ void DestroyDebugUtilsMessengerEXT(
 	if (func != nullptr) { func(instance, debugMessenger, pAllocator); }
 }
 
-void cleanupSwapchain() {
-	vkDestroyImageView(device, depthImageView, nullptr);
-	vkDestroyImage(device, depthImage, nullptr);
-	vkFreeMemory(device, depthImageMemory, nullptr);
+//Retires everything that belongs to the current swapchain through the deletion queue, the depth image unless it is kept for the next swapchain.
+//The swapchain handle stays valid until then, createSwapchain() passes it as oldSwapchain
+void cleanupSwapchain(bool keepDepth = false) {
+	if (!keepDepth) {
+		deferDestroyImageView(depthImageView);
+		deferDestroyImage(depthImage, depthImageMemory);
+	}
 	for (auto framebuffer : swapChainFramebuffers) {
-		vkDestroyFramebuffer(device, framebuffer, nullptr); }
+		deferDestroyFramebuffer(framebuffer); }
 	for (auto imageView : swapChainImageViews) {
-		vkDestroyImageView(device, imageView, nullptr); }
-	vkDestroySwapchainKHR(device, swapChain, nullptr);
+		deferDestroyImageView(imageView); }
+
+	if (HEADLESS) {
+		for (size_t i = 0; i < swapChainImages.size(); i++) { deferDestroyImage(swapChainImages[i], offscreenImagesMemory[i]); }
+		return;
+	}
+
+	//Frame fences do not cover presentation, so the old swapchain is also kept until the first frame on the new one is done
+	VkSwapchainKHR retiredSwapChain = swapChain;
+	deferDestruction([this, retiredSwapChain]() { vkDestroySwapchainKHR(device, retiredSwapChain, nullptr); }, 1);
+}
+
+//Everything sized by framesInFlight. The device has to be idle
+void cleanupFrameResources() {
+	for (size_t i = 0; i < framesInFlight; i++) {
+		destroyBuffer(uniformBuffers[i], uniformBuffersMemory[i]);
+	}
+
+	vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+	vkFreeCommandBuffers(device, commandPool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+
+	for (size_t i = 0; i < framesInFlight; i++) {
+		vkDestroySemaphore(device, imageAvailableSemaphores[i], nullptr);
+		vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
+		vkDestroyFence(device, inFlightFences[i], nullptr);
+	}
 }
 
 void cleanup() {
+	assetLoader.reset(); //Joins the workers, a window closed while loading drops the assets that are not uploaded yet
 	vkDeviceWaitIdle(device); //Wait for logical device to finish operations before cleanup
+	reportMeshletCulling();
+	reportLodStats();
+	reportSwapchainStats();
 
 	cleanupSwapchain();
-	vkDestroyPipeline(device, graphicsPipeline, nullptr);
+	destroyPipelines();
+	destroyPipelineCache();
 	vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
 	vkDestroyRenderPass(device, renderPass, nullptr);
 
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-		vkDestroyBuffer(device, uniformBuffers[i], nullptr);
-		vkFreeMemory(device, uniformBuffersMemory[i], nullptr);
-	}
-
-	vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+	cleanupFrameResources();
 
 	vkDestroySampler(device, textureSampler, nullptr);
 	vkDestroyImageView(device, textureImageView, nullptr);
 
-	vkDestroyImage(device, textureImage, nullptr);
-	vkFreeMemory(device, textureImageMemory, nullptr);
+	if (textureImage != VK_NULL_HANDLE) { destroyImage(textureImage, textureImageMemory); }
+	unloadPlaceholderAssets();
 
 	vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 
-	vkDestroyBuffer(device, indexBuffer, nullptr);
-	vkFreeMemory(device, indexBufferMemory, nullptr);
+	if (indexBuffer != VK_NULL_HANDLE) { destroyBuffer(indexBuffer, indexBufferMemory); }
 
-	vkDestroyBuffer(device, vertexBuffer, nullptr);
-	vkFreeMemory(device, vertexBufferMemory, nullptr);
+	if (vertexBuffer != VK_NULL_HANDLE) { destroyBuffer(vertexBuffer, vertexBufferMemory); }
 
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-		vkDestroySemaphore(device, imageAvailableSemaphores[i], nullptr);
-		vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
-		vkDestroyFence(device, inFlightFences[i], nullptr);
-	}
+	cleanupInstanceBuffer();
 
+	vkDestroySemaphore(device, frameTimeline, nullptr);
+
+	deletionQueue.flush(); //The device is idle
+	destroyStagingRing();
+	destroyGpuProfiler();
+	vkDestroyCommandPool(device, transferCommandPool, nullptr);
 	vkDestroyCommandPool(device, commandPool, nullptr);
+	destroyMemoryAllocator();
 	vkDestroyDevice(device, nullptr);
 
 	if (enableValidationLayers) { DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr); }
@@ -61,7 +89,9 @@ void cleanup() {
 	vkDestroySurfaceKHR(instance, surface, nullptr);
 	vkDestroyInstance(instance, nullptr);
 
-	glfwDestroyWindow(window);
-	glfwTerminate();
+	if (!HEADLESS) {
+		glfwDestroyWindow(window);
+		glfwTerminate();
+	}
 	if (enableValidationLayers == true){ std::cout << "Cleanup done." << std::endl; }
 }
\ No newline at end of file
@@ -5,10 +5,14 @@ void createCommandPool() {
 		poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
 
 	if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) { throw std::runtime_error("failed to create command pool!"); }
+
+	//Upload command buffers for the transfer queue
+		poolInfo.queueFamilyIndex = queueFamilyIndices.transferFamily.value();
+	if (vkCreateCommandPool(device, &poolInfo, nullptr, &transferCommandPool) != VK_SUCCESS) { throw std::runtime_error("failed to create transfer command pool!"); }
 }
 
 void createCommandBuffers() {
-	commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+	commandBuffers.resize(framesInFlight);
 
 	VkCommandBufferAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -24,6 +28,7 @@ void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
 	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) { throw std::runtime_error("failed to begin recording command buffer!"); }
+	beginGpuProfiling(commandBuffer, queueFamilyIndices.graphicsFamily.value(), "frame");
 
 		VkRenderPassBeginInfo renderPassInfo{};
 			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -40,9 +45,10 @@ void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
 			renderPassInfo.pClearValues = clearValues.data();
 
 		//The render pass can now begin. All of the functions that record commands can be recognized by their vkCmd prefix. They all return void, so there will be no error handling until we’ve finished recording.
+		uint32_t renderPassScope = beginGpuScope(commandBuffer, "render_pass");
 		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, scenePipeline);
 
 			VkViewport viewport{}; //Specified dynamic in fixed function pipeline so need to be set here
 				viewport.x = 0.0f;
@@ -58,59 +64,56 @@ void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
 				scissor.extent = swapChainExtent;
 			vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-			//Bind the Vertex Buffer
-			VkBuffer vertexBuffers[] = {vertexBuffer};
-			VkDeviceSize offsets[] = {0};
-			vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-
-			//Bind the Index Buffer
-			vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-
-			//Bind Descriptor Sets
-			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
-
-			//Draw
-			vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+			//Every draw goes through here so GPU_PROFILE_DRAWS can time it
+			GpuProfiler* drawProfiler = GPU_PROFILE_DRAWS ? gpuProfiler.get() : nullptr;
+			auto drawIndexed = [commandBuffer, drawProfiler](uint32_t indexCount, uint32_t instances, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {
+				GpuScope drawScope(drawProfiler, commandBuffer, "draw");
+				vkCmdDrawIndexed(commandBuffer, indexCount, instances, firstIndex, vertexOffset, firstInstance);
+			};
+
+			//Placeholder cube until the model is resident. Nothing is drawn when instancing, the instance grid is laid out from the model's bounds
+			if (!modelResident) {
+				if (!USE_INSTANCING) {
+					VkDeviceSize offset = 0;
+					vkCmdBindVertexBuffers(commandBuffer, 0, 1, &placeholderVertexBuffer, &offset);
+					vkCmdBindIndexBuffer(commandBuffer, placeholderIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+					vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
+					drawIndexed(placeholderIndexCount, 1, 0, 0, 0);
+				}
+			} else {
+				//Bind the Vertex Buffer
+				VkBuffer vertexBuffers[] = {vertexBuffer};
+				VkDeviceSize offsets[] = {0};
+				vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+				if (USE_INSTANCING) { vkCmdBindVertexBuffers(commandBuffer, 1, 1, &instanceBuffer, offsets); }
+
+				//Bind the Index Buffer
+				vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, indexType);
+
+				//Bind Descriptor Sets
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
+
+				//Draw, one call per visible meshlet at full detail or per 16-bit index range of the selected LOD, covering every instance
+				uint32_t lod = selectLod(frameUniforms);
+				if (RENDER_PATH == RenderPath::Meshlets && lod == 0 && !USE_INSTANCING) {
+					cullMeshlets(frameUniforms);
+					for (uint32_t i : visibleMeshlets) { drawIndexed(meshlets[i].triangleCount * 3, 1, meshlets[i].firstIndex, meshlets[i].vertexOffset, 0); }
+				} else {
+					for (const IndexRange& range : clipIndexRanges(indexRanges, lods[lod].firstIndex, lods[lod].indexCount)) {
+						if (drawInstancesSeparately) {
+							for (uint32_t instance = 0; instance < instanceCount; instance++) { drawIndexed(range.indexCount, 1, range.firstIndex, range.vertexOffset, instance); }
+						} else {
+							drawIndexed(range.indexCount, instanceCount, range.firstIndex, range.vertexOffset, 0);
+						}
+					}
+				}
+			}
 
 		//End render pass
 		vkCmdEndRenderPass(commandBuffer);
+		endGpuScope(commandBuffer, renderPassScope);
 
 	//Finish recording
+	endGpuProfiling(commandBuffer);
 	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) { throw std::runtime_error("failed to record command buffer!"); }
-}
-
-VkCommandBuffer beginSingleTimeCommands() {
-	//Create temporary command buffer
-	VkCommandBufferAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandPool = commandPool;
-		allocInfo.commandBufferCount = 1;
-
-	VkCommandBuffer commandBuffer;
-	vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
-
-	//Start recording command buffer
-	VkCommandBufferBeginInfo beginInfo{};
-		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-	vkBeginCommandBuffer(commandBuffer, &beginInfo);
-	return commandBuffer;
-}
-
-void endSingleTimeCommands(VkCommandBuffer commandBuffer) {
-	//Stop recording buffer
-	vkEndCommandBuffer(commandBuffer);
-
-	//Wait for transfer to complete
-	VkSubmitInfo submitInfo{};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffer;
-
-	vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-	vkQueueWaitIdle(graphicsQueue);
-
-	//Clean up command buffer
-	vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
 }
\ No newline at end of file
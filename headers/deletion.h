@@ -0,0 +1,28 @@
+//Deferred destruction. A resource handed to one of these is destroyed once every frame submitted so far and every upload recorded so far have finished
+//on the GPU, instead of draining the device first. extraFrames holds it for that many further frames
+void deferDestruction(std::function<void()> destroy, uint64_t extraFrames = 0) {
+	UploadTicket lastUpload = uploadBatch ? nextUploadTicket : nextUploadTicket - 1; //The open batch gets the next ticket when it is flushed
+	deletionQueue.push(frameNumber + extraFrames, lastUpload, std::move(destroy));
+}
+
+void deferDestroyBuffer(VkBuffer buffer, MemoryAllocation bufferMemory) {
+	deferDestruction([this, buffer, bufferMemory]() mutable { destroyBuffer(buffer, bufferMemory); });
+}
+
+void deferDestroyImage(VkImage image, MemoryAllocation imageMemory) {
+	deferDestruction([this, image, imageMemory]() mutable { destroyImage(image, imageMemory); });
+}
+
+void deferDestroyImageView(VkImageView imageView) {
+	deferDestruction([this, imageView]() { vkDestroyImageView(device, imageView, nullptr); });
+}
+
+void deferDestroyFramebuffer(VkFramebuffer framebuffer) {
+	deferDestruction([this, framebuffer]() { vkDestroyFramebuffer(device, framebuffer, nullptr); });
+}
+
+//Called once per frame after the frame slot wait
+void collectDeletions() {
+	reclaimStaging(false);
+	deletionQueue.collect(completedFrameNumber(), completedUploadTicket);
+}
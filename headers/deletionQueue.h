@@ -0,0 +1,37 @@
+//Destruction deferred until the GPU is done with a resource. Each entry records the newest frame number and upload ticket that may still use it,
+//collect() runs every entry both counters have passed, in push order. Entries pushed with extra frames (the retired swapchain) are ahead of later
+//ones, so collect() scans past entries that are not ready instead of stopping at the first
+class DeletionQueue {
+public:
+	void push(uint64_t frame, uint64_t uploadTicket, std::function<void()> destroy) { entries.push_back({frame, uploadTicket, std::move(destroy)}); }
+
+	size_t collect(uint64_t completedFrame, uint64_t completedUploadTicket) {
+		//Take the ready entries out first, a destroy function may push new entries
+		std::vector<std::function<void()>> ready;
+		auto kept = entries.begin();
+		for (auto entry = entries.begin(); entry != entries.end(); ++entry) {
+			if (entry->frame <= completedFrame && entry->uploadTicket <= completedUploadTicket) { ready.push_back(std::move(entry->destroy)); }
+			else {
+				if (kept != entry) { *kept = std::move(*entry); }
+				++kept;
+			}
+		}
+		entries.erase(kept, entries.end());
+
+		for (auto& destroy : ready) { destroy(); }
+		return ready.size();
+	}
+
+	//Only once the device is idle
+	void flush() { collect(std::numeric_limits<uint64_t>::max(), std::numeric_limits<uint64_t>::max()); }
+
+	size_t size() const { return entries.size(); }
+
+private:
+	struct Entry {
+		uint64_t frame;
+		uint64_t uploadTicket;
+		std::function<void()> destroy;
+	};
+	std::deque<Entry> entries;
+};
@@ -19,6 +19,7 @@ VkFormat findDepthFormat() {
 void createDepthResources() {
 	VkFormat depthFormat = findDepthFormat();
 
+	depthExtent = swapChainExtent;
 	createImage(swapChainExtent.width, swapChainExtent.height, 1, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthImage, depthImageMemory);
 	depthImageView = createImageView(depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1);
 }
\ No newline at end of file
@@ -7,22 +7,33 @@ QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device) {
 	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
 	vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
 
-	int i = 0;
+	uint32_t i = 0;
 	for (const auto& queueFamily : queueFamilies) {
-		if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) { //Find at least one queue family that supports VK_QUEUE_GRAPHICS_BIT
+		if (!indices.graphicsFamily && (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)) { //Find at least one queue family that supports VK_QUEUE_GRAPHICS_BIT
 			indices.graphicsFamily = i; }
 
 		VkBool32 presentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport); //Look for a queue family with surface support
-		if (presentSupport) { indices.presentFamily = i; }
-
-		//Early exit
-		if (indices.isComplete()) { break; }
+		if (HEADLESS) { presentSupport = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) ? VK_TRUE : VK_FALSE; } //Nothing is presented, the graphics family stands in
+		else { vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport); } //Look for a queue family with surface support
+		if (!indices.presentFamily && presentSupport) { indices.presentFamily = i; }
+
+		//Separate family for uploads, preferring transfer only (the DMA engines) over async compute. Row chunked image copies need a 1x1x1 transfer granularity
+		VkExtent3D granularity = queueFamily.minImageTransferGranularity;
+		bool transferCapable = (queueFamily.queueFlags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_COMPUTE_BIT)) && !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT);
+		if (transferCapable && granularity.width == 1 && granularity.height == 1 && granularity.depth == 1) {
+			if (!indices.transferFamily || !(queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT)) { indices.transferFamily = i; }
+		}
 		i++;
 	}
 	return indices;
 }
 
+//VK_KHR_swapchain is not needed headless, software implementations may not have it
+std::vector<const char*> requiredDeviceExtensions() {
+	if (HEADLESS) { return {}; }
+	return deviceExtensions;
+}
+
 bool checkDeviceExtensionSupport(VkPhysicalDevice device) {
 	uint32_t extensionCount;
 	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
@@ -30,7 +41,8 @@ bool checkDeviceExtensionSupport(VkPhysicalDevice device) {
 	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
 	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
-	std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
+	std::vector<const char*> extensions = requiredDeviceExtensions();
+	std::set<std::string> requiredExtensions(extensions.begin(), extensions.end());
 
 	for (const auto& extension : availableExtensions) { requiredExtensions.erase(extension.extensionName); }
 	return requiredExtensions.empty();
@@ -50,8 +62,8 @@ void pickPhysicalDevice() {
 
 		bool extensionsSupported = checkDeviceExtensionSupport(device);
 
-		bool swapChainAdequate = false;
-		if (extensionsSupported) {
+		bool swapChainAdequate = HEADLESS;
+		if (extensionsSupported && !HEADLESS) {
 			SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
 			swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
 		}
@@ -66,9 +78,13 @@ void pickPhysicalDevice() {
 	if (physicalDevice == VK_NULL_HANDLE) { throw std::runtime_error("failed to find a suitable GPU!"); }
 }
 
+bool hasTransferQueue() const { return queueFamilyIndices.transferFamily != queueFamilyIndices.graphicsFamily; }
+
 void createDevice() {
 	std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-	std::set<uint32_t> uniqueQueueFamilies = {queueFamilyIndices.graphicsFamily.value(), queueFamilyIndices.presentFamily.value()};
+	//Uploads fall back to the graphics family when there is no separate transfer family or it is turned off
+	if (!USE_TRANSFER_QUEUE || !queueFamilyIndices.transferFamily) { queueFamilyIndices.transferFamily = queueFamilyIndices.graphicsFamily; }
+	std::set<uint32_t> uniqueQueueFamilies = {queueFamilyIndices.graphicsFamily.value(), queueFamilyIndices.presentFamily.value(), queueFamilyIndices.transferFamily.value()};
 
 	float queuePriority = 1.0f; //Queue priority between 0.0 and 1.0 required even if there is only a single queue		
 	for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -82,13 +98,33 @@ void createDevice() {
 	VkPhysicalDeviceFeatures deviceFeatures{}; //Get device features
 		deviceFeatures.samplerAnisotropy = VK_TRUE; //Request Anisotropic Filtering function
 
+	//Timeline semaphores if the device is 1.2 and supports them, fences otherwise. Host query reset for the GPU profiler the same way
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	VkPhysicalDeviceVulkan12Features supportedFeatures12{};
+		supportedFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	if ((USE_TIMELINE_SEMAPHORES || GPU_PROFILING) && properties.apiVersion >= VK_API_VERSION_1_2) {
+		VkPhysicalDeviceFeatures2 supportedFeatures{};
+			supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			supportedFeatures.pNext = &supportedFeatures12;
+		vkGetPhysicalDeviceFeatures2(physicalDevice, &supportedFeatures);
+	}
+	useTimelineSemaphores = USE_TIMELINE_SEMAPHORES && supportedFeatures12.timelineSemaphore == VK_TRUE;
+	hostQueryReset = GPU_PROFILING && supportedFeatures12.hostQueryReset == VK_TRUE;
+	VkPhysicalDeviceVulkan12Features deviceFeatures12{};
+		deviceFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		deviceFeatures12.timelineSemaphore = useTimelineSemaphores ? VK_TRUE : VK_FALSE;
+		deviceFeatures12.hostQueryReset = hostQueryReset ? VK_TRUE : VK_FALSE;
+
 	VkDeviceCreateInfo deviceInfo{};
 		deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		deviceInfo.pNext = useTimelineSemaphores || hostQueryReset ? &deviceFeatures12 : nullptr;
 		deviceInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		deviceInfo.pQueueCreateInfos = queueCreateInfos.data();
 		deviceInfo.pEnabledFeatures = &deviceFeatures;
-		deviceInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-		deviceInfo.ppEnabledExtensionNames = deviceExtensions.data();
+	std::vector<const char*> extensions = requiredDeviceExtensions();
+		deviceInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+		deviceInfo.ppEnabledExtensionNames = extensions.data();
 
 	if (enableValidationLayers) {
 		deviceInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -101,4 +137,7 @@ void createDevice() {
 	//Retrieve queue handles
 	vkGetDeviceQueue(device, queueFamilyIndices.graphicsFamily.value(), 0, &graphicsQueue);
 	vkGetDeviceQueue(device, queueFamilyIndices.presentFamily.value(), 0, &presentQueue);
+	vkGetDeviceQueue(device, queueFamilyIndices.transferFamily.value(), 0, &transferQueue);
+	std::cout << "Uploads on " << (hasTransferQueue() ? "dedicated transfer queue family " : "graphics queue family ") << queueFamilyIndices.transferFamily.value() << std::endl;
+	std::cout << "Frame and upload sync: " << (useTimelineSemaphores ? "timeline semaphores" : "fences") << std::endl;
 }
\ No newline at end of file
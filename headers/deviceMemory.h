@@ -0,0 +1,43 @@
+//Every buffer and image gets its memory from memoryAllocator, created right after the device and destroyed right before it
+void createMemoryAllocator() {
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+	VkPhysicalDeviceMemoryProperties memProperties;
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+
+	std::vector<VkMemoryPropertyFlags> memoryTypeFlags(memProperties.memoryTypeCount);
+	for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) { memoryTypeFlags[i] = memProperties.memoryTypes[i].propertyFlags; }
+
+	MemoryBackend backend;
+		backend.allocate = [this](uint32_t memoryTypeIndex, VkDeviceSize size) {
+			VkMemoryAllocateInfo memoryAllocInfo{};
+				memoryAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+				memoryAllocInfo.allocationSize = size;
+				memoryAllocInfo.memoryTypeIndex = memoryTypeIndex;
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			if (vkAllocateMemory(device, &memoryAllocInfo, nullptr, &memory) != VK_SUCCESS) { return static_cast<VkDeviceMemory>(VK_NULL_HANDLE); }
+			return memory;
+		};
+		backend.free = [this](VkDeviceMemory memory) { vkFreeMemory(device, memory, nullptr); };
+		backend.map = [this](VkDeviceMemory memory) {
+			void* data = nullptr;
+			if (vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data) != VK_SUCCESS) { throw std::runtime_error("failed to map memory block!"); }
+			return data;
+		};
+
+	memoryAllocator = std::make_unique<MemoryAllocator>(backend, memoryTypeFlags, MEMORY_BLOCK_SIZE, deviceProperties.limits.bufferImageGranularity);
+}
+
+void reportMemoryStats() {
+	MemoryAllocatorStats stats = memoryAllocator->getStats();
+	std::cout << "Device memory: " << stats.allocationCount << " resources in " << stats.blockCount << " blocks (" << stats.dedicatedBlockCount << " dedicated, "
+		<< stats.deviceAllocations << " vkAllocateMemory calls so far), " << stats.usedBytes / 1048576.0 << " of " << stats.reservedBytes / 1048576.0 << " MB used, "
+		<< stats.wastedBytes / 1024.0 << " KB wasted on granularity padding, " << stats.freeRangeCount << " free ranges, largest " << stats.largestFreeRange / 1048576.0
+		<< " MB, fragmentation " << stats.fragmentation * 100.0 << "%" << std::endl;
+}
+
+void destroyMemoryAllocator() {
+	MemoryAllocatorStats stats = memoryAllocator->getStats();
+	if (stats.allocationCount > 0) { std::cerr << stats.allocationCount << " device memory allocations still live at shutdown" << std::endl; }
+	memoryAllocator.reset();
+}
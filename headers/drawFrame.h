@@ -6,30 +6,62 @@ void updateUniformBuffer(uint32_t currentImage) {
 
 	UniformBufferObject ubo{};
 		ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-		ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-		ubo.proj = glm::perspective(glm::radians(45.0f), swapChainExtent.width / (float) swapChainExtent.height, 0.1f, 10.0f);
+		ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f) * instanceViewScale, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+		ubo.proj = glm::perspective(glm::radians(45.0f), swapChainExtent.width / (float) swapChainExtent.height, 0.1f * instanceViewScale, 10.0f * instanceViewScale);
 		ubo.proj[1][1] *= -1; //correction | GLM was originally designed for OpenGL, where the Y coordinate of the clip coordinates is inverted
+		ubo.positionOffset = glm::vec4((modelResident ? vertexQuantization : placeholderQuantization).offset, 0.0f);
+		ubo.positionScale = glm::vec4((modelResident ? vertexQuantization : placeholderQuantization).scale, 0.0f);
 	memcpy(uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
+	frameUniforms = ubo;
 }
 
 void drawFrame() {
-	vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX); //VK_TRUE parameter indicates waiting for all fences, UINT64_MAX effectively disables timeout
-
-	//Get image from swapchain
-	uint32_t imageIndex;
-	VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
-	if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-		recreateSwapChain();
-		return;
-	} else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) { throw std::runtime_error("failed to acquire swap chain image!"); }
-
+	//CPU time per stage, kept in lastFrameTiming once the frame is submitted and traced with TRACING
+	TraceScope frameScope("drawFrame", "frame");
+	FrameTiming timing;
+	auto frameStartTime = Trace::Clock::now();
+	auto stageStartTime = frameStartTime;
+	auto endStage = [&stageStartTime](double& stageTime, const char* name) {
+		auto now = Trace::Clock::now();
+		stageTime = std::chrono::duration<double, std::milli>(now - stageStartTime).count();
+		Trace::complete(name, "frame", Trace::timestamp(stageStartTime), Trace::timestamp(now));
+		stageStartTime = now;
+	};
+
+	waitForFrameSlot();
+	endStage(timing.fenceWait, "fence_wait");
+
+	//Get image from swapchain, headless renders into the offscreen target of the frame slot
+	uint32_t imageIndex = currentFrame;
+	if (!HEADLESS) {
+		VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+		if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+			noteResize();
+			recreateSwapChain();
+			return;
+		} else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) { throw std::runtime_error("failed to acquire swap chain image!"); }
+	}
+	endStage(timing.acquire, "acquire");
+
+	collectDeletions(); //Streaming uploads get their ring space back and retired resources are destroyed as soon as the GPU is done with them
+	collectGpuTimings();
+	updatePipelineCache();
+	updatePipelines();
+	updateAssets();
+	refreshTextureDescriptor(currentFrame);
+	unloadPlaceholderAssets(false);
 	updateUniformBuffer(currentFrame);
 
-	vkResetFences(device, 1, &inFlightFences[currentFrame]); //Only reset the fence if we are submitting work
+	flushUploads(); //Anything uploaded since the last frame has to be submitted before the frame that uses it
+	endStage(timing.update, "update");
+
+	auto submitStartTime = std::chrono::high_resolution_clock::now();
+	if (!useTimelineSemaphores) { vkResetFences(device, 1, &inFlightFences[currentFrame]); } //Only reset the fence if we are submitting work
 
 	//Recording the command buffer
 	vkResetCommandBuffer(commandBuffers[currentFrame],  0);
 	recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
+	endStage(timing.record, "record");
 
 	//Submitting the command buffer
 	VkSubmitInfo submitInfo{};
@@ -37,35 +69,59 @@ void drawFrame() {
 
 	VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
 	VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.waitSemaphoreCount = HEADLESS ? 0 : 1;
 		submitInfo.pWaitSemaphores = waitSemaphores;
 		submitInfo.pWaitDstStageMask = waitStages;
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
 
-	VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-		submitInfo.signalSemaphoreCount = 1;
-		submitInfo.pSignalSemaphores = signalSemaphores;
-
-	if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) { throw std::runtime_error("failed to submit draw command buffer!"); }
+	//The frame number goes on frameTimeline, the binary value is ignored. Headless skips renderFinished, nothing presents
+	VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame], frameTimeline};
+	uint64_t signalValues[] = {0, ++frameNumber};
+	uint32_t firstSignal = HEADLESS ? 1 : 0;
+		submitInfo.signalSemaphoreCount = (useTimelineSemaphores ? 2 : 1) - firstSignal;
+		submitInfo.pSignalSemaphores = signalSemaphores + firstSignal;
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.signalSemaphoreValueCount = 2 - firstSignal;
+		timelineInfo.pSignalSemaphoreValues = signalValues + firstSignal;
+		submitInfo.pNext = useTimelineSemaphores ? &timelineInfo : nullptr;
+
+	VkFence fence = useTimelineSemaphores ? VK_NULL_HANDLE : inFlightFences[currentFrame];
+	if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, fence) != VK_SUCCESS) { throw std::runtime_error("failed to submit draw command buffer!"); }
+	lastSubmitTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - submitStartTime).count();
+	endStage(timing.submit, "submit");
+
+	if (!HEADLESS) { presentFrame(imageIndex); }
+	endStage(timing.present, "present");
+	timing.total = std::chrono::duration<double, std::milli>(stageStartTime - frameStartTime).count();
+	lastFrameTiming = timing;
+	if (!firstFramePresented) {
+		firstFramePresented = true;
+		std::cout << "Time to first frame " << millisecondsSinceStartup() << " ms" << (modelResident && textureResident ? "" : ", assets still loading") << std::endl;
+	}
+	currentFrame = (currentFrame + 1) % framesInFlight;
+}
 
-	//Presentation
+void presentFrame(uint32_t imageIndex) {
 	VkPresentInfoKHR presentInfo{};
 		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
 		presentInfo.waitSemaphoreCount = 1;
-		presentInfo.pWaitSemaphores = signalSemaphores;
+		presentInfo.pWaitSemaphores = &renderFinishedSemaphores[currentFrame];
 
 	VkSwapchainKHR swapChains[] = {swapChain};
 		presentInfo.swapchainCount = 1;
 		presentInfo.pSwapchains = swapChains;
 		presentInfo.pImageIndices = &imageIndex;
 
-	result = vkQueuePresentKHR(presentQueue, &presentInfo);
+	VkResult result = vkQueuePresentKHR(presentQueue, &presentInfo);
 
 	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized) {
 		framebufferResized = false;
+		noteResize();
 		recreateSwapChain(); }
 	else if (result != VK_SUCCESS) { throw std::runtime_error("failed to present swap chain image!"); }
-	currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+	else { notePresent(); }
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+//Frame benchmark (RUN_FRAME_BENCHMARK). After FRAME_BENCHMARK_WARMUP_FRAMES, the stage timings of every submitted frame are collected for
+//FRAME_BENCHMARK_FRAMES frames or FRAME_BENCHMARK_SECONDS and summarized into FRAME_BENCHMARK_OUTPUT.json and .csv, so runs of two builds can be
+//compared. Run it HEADLESS to keep the display out of the numbers
+void runFrameBenchmark() {
+	waitForAssets();
+	for (uint32_t frame = 0; frame < FRAME_BENCHMARK_WARMUP_FRAMES; frame++) { pollWindowEvents(); drawFrame(); }
+
+	BenchmarkStatistics statistics;
+	uint32_t frames = 0;
+	auto startTime = std::chrono::high_resolution_clock::now();
+	auto elapsedTime = [&startTime]() { return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count(); };
+	while (FRAME_BENCHMARK_FRAMES > 0 ? frames < FRAME_BENCHMARK_FRAMES : elapsedTime() < FRAME_BENCHMARK_SECONDS) {
+		if (!HEADLESS && glfwWindowShouldClose(window)) { break; }
+		pollWindowEvents();
+		uint64_t submittedFrames = frameNumber;
+		drawFrame();
+		if (frameNumber == submittedFrames) { continue; } //Swapchain was out of date, nothing was rendered
+
+		frames++;
+		statistics.add("frame", lastFrameTiming.total);
+		statistics.add("fence_wait", lastFrameTiming.fenceWait);
+		statistics.add("acquire", lastFrameTiming.acquire);
+		statistics.add("update", lastFrameTiming.update);
+		statistics.add("record", lastFrameTiming.record);
+		statistics.add("submit", lastFrameTiming.submit);
+		statistics.add("present", lastFrameTiming.present);
+		for (const GpuTiming& timing : lastGpuTimings) { statistics.add(std::string("gpu_") + timing.name, timing.milliseconds()); } //Earlier frames, GPU_PROFILING
+	}
+	vkDeviceWaitIdle(device);
+	double totalTime = elapsedTime();
+
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	std::vector<std::pair<std::string, std::string>> runProperties = {
+		{"device", properties.deviceName},
+		{"extent", std::to_string(swapChainExtent.width) + "x" + std::to_string(swapChainExtent.height)},
+		{"headless", HEADLESS ? "true" : "false"},
+		{"framesInFlight", std::to_string(framesInFlight)},
+		{"sync", useTimelineSemaphores ? "timeline" : "fences"},
+		{"gpuProfiling", gpuProfiler ? "true" : "false"},
+		{"warmupFrames", std::to_string(FRAME_BENCHMARK_WARMUP_FRAMES)},
+		{"frames", std::to_string(frames)},
+		{"seconds", std::to_string(totalTime)}
+	};
+	statistics.writeJson(FRAME_BENCHMARK_OUTPUT + ".json", runProperties, FRAME_BENCHMARK_HISTOGRAM_BINS);
+	statistics.writeCsv(FRAME_BENCHMARK_OUTPUT + ".csv");
+
+	std::cout << "Frame benchmark, " << frames << " frames in " << std::fixed << std::setprecision(3) << totalTime << " s, " << frames / totalTime
+		<< " fps, written to " << FRAME_BENCHMARK_OUTPUT << ".json and .csv" << std::endl;
+	std::cout << "  stage           |    mean ms |     p50 ms |     p95 ms |     p99 ms |     max ms" << std::endl;
+	for (const std::string& series : statistics.seriesNames()) {
+		SampleSummary summary = statistics.summarize(series, 1);
+		std::cout << "  " << std::left << std::setw(15) << series << std::right << " | " << std::setw(10) << summary.mean << " | " << std::setw(10) << summary.p50
+			<< " | " << std::setw(10) << summary.p95 << " | " << std::setw(10) << summary.p99 << " | " << std::setw(10) << summary.max << std::endl;
+	}
+	std::cout << std::defaultfloat;
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+//Changes the CPU/GPU pipelining depth. Rebuilds the uniform buffers, descriptor sets, command buffers and sync objects for the new count, which needs
+//an idle device, so this is for configuration changes and benchmarks, not per frame
+void setFramesInFlight(uint32_t count) {
+	if (count < 1 || count > MAX_FRAMES_IN_FLIGHT) { throw std::invalid_argument("frames in flight out of range!"); }
+	if (count == framesInFlight) { return; }
+
+	vkDeviceWaitIdle(device);
+	cleanupFrameResources();
+	framesInFlight = count;
+	currentFrame = 0;
+	fenceCompletedFrame = frameNumber; //Everything submitted so far is done
+
+	createUniformBuffer();
+	createDescriptorPool();
+	createDescriptorSets();
+	createCommandBuffers();
+	createSyncObjects();
+}
+
+//Every depth in FRAMES_IN_FLIGHT_BENCHMARK_DEPTHS. CPU wait is the time drawFrame() blocks on the frame slot (inFlightFences, or frameTimeline in
+//timeline mode). It drops as the depth grows while the GPU is the bottleneck, at the cost of that many frames of latency
+void runFramesInFlightBenchmark() {
+	struct Result {
+		uint32_t depth;
+		double waitTime;
+		double maxWaitTime;
+		double frameTime;
+	};
+	std::vector<Result> results;
+	waitForAssets();
+
+	uint32_t initialDepth = framesInFlight;
+	for (uint32_t depth : FRAMES_IN_FLIGHT_BENCHMARK_DEPTHS) {
+		setFramesInFlight(depth);
+		for (uint32_t frame = 0; frame < FRAMES_IN_FLIGHT_BENCHMARK_FRAMES / 10; frame++) { pollWindowEvents(); drawFrame(); }
+
+		double waitTime = 0.0, maxWaitTime = 0.0;
+		auto startTime = std::chrono::high_resolution_clock::now();
+		for (uint32_t frame = 0; frame < FRAMES_IN_FLIGHT_BENCHMARK_FRAMES; frame++) {
+			pollWindowEvents();
+			drawFrame();
+			waitTime += lastFrameWaitTime;
+			maxWaitTime = std::max(maxWaitTime, lastFrameWaitTime);
+		}
+		vkDeviceWaitIdle(device);
+		auto endTime = std::chrono::high_resolution_clock::now();
+		results.push_back({depth, waitTime / FRAMES_IN_FLIGHT_BENCHMARK_FRAMES, maxWaitTime,
+			std::chrono::duration<double, std::milli>(endTime - startTime).count() / FRAMES_IN_FLIGHT_BENCHMARK_FRAMES});
+	}
+	setFramesInFlight(initialDepth);
+
+	std::cout << "Frames in flight benchmark, " << FRAMES_IN_FLIGHT_BENCHMARK_FRAMES << " frames per depth, " << (useTimelineSemaphores ? "timeline semaphores" : "fences") << std::endl;
+	std::cout << "  depth | CPU wait ms | max wait ms | frame ms" << std::endl;
+	for (const Result& result : results) {
+		std::cout << "  " << std::setw(5) << result.depth << " | " << std::setw(11) << std::fixed << std::setprecision(3) << result.waitTime << " | "
+			<< std::setw(11) << result.maxWaitTime << " | " << std::setw(8) << result.frameTime << std::defaultfloat << std::endl;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,157 @@
+//GPU time of a named scope, in nanoseconds on the device timestamp clock. Names are string literals
+struct GpuTiming {
+	const char* name;
+	double begin;
+	double end;
+
+	double milliseconds() const { return (end - begin) / 1e6; }
+};
+
+//Timestamp queries around scopes of command buffers. Each profiled command buffer gets a block of the query pool for its recording, scopes are pairs of
+//queries in it. Blocks are read back without waiting once every query in them is available, which is some frames after the submit, and only reused
+//after that. Without host query reset the block is reset in the command buffer itself, so the queue must support vkCmdResetQueryPool
+class GpuProfiler {
+public:
+	GpuProfiler(VkDevice device, float timestampPeriod, bool hostQueryReset, uint32_t blockCount, uint32_t queriesPerBlock)
+		: device(device), period(timestampPeriod), hostReset(hostQueryReset), queriesPerBlock(queriesPerBlock & ~1u), blocks(blockCount) {
+		VkQueryPoolCreateInfo poolInfo{};
+			poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			poolInfo.queryCount = blockCount * this->queriesPerBlock;
+		if (vkCreateQueryPool(device, &poolInfo, nullptr, &queryPool) != VK_SUCCESS) { throw std::runtime_error("failed to create timestamp query pool!"); }
+		if (hostReset) { vkResetQueryPool(device, queryPool, 0, poolInfo.queryCount); }
+		for (uint32_t i = blockCount; i > 0; i--) { freeBlocks.push_back(i - 1); }
+	}
+
+	//Only once the device is idle
+	~GpuProfiler() { vkDestroyQueryPool(device, queryPool, nullptr); }
+
+	GpuProfiler(const GpuProfiler&) = delete;
+	GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+	//Starts profiling a command buffer that is being recorded, outside of a render pass, with a scope named name around everything up to end().
+	//timestampValidBits of the queue family it is submitted to, 0 skips it
+	void begin(VkCommandBuffer commandBuffer, uint32_t timestampValidBits, const char* name) {
+		if (timestampValidBits == 0 || openBlocks.count(commandBuffer)) { return; }
+		if (freeBlocks.empty()) { droppedCommandBuffers++; return; }
+
+		uint32_t block = freeBlocks.back();
+		freeBlocks.pop_back();
+		blocks[block].validBits = timestampValidBits;
+		blocks[block].scopes.clear();
+		if (!hostReset) { vkCmdResetQueryPool(commandBuffer, queryPool, block * queriesPerBlock, queriesPerBlock); }
+		openBlocks[commandBuffer] = block;
+		beginScope(commandBuffer, name);
+	}
+
+	//Closes the outer scope, the command buffer has to be submitted as recorded
+	void end(VkCommandBuffer commandBuffer) {
+		auto found = openBlocks.find(commandBuffer);
+		if (found == openBlocks.end()) { return; }
+		endScope(commandBuffer, 0);
+		pendingBlocks.push_back(found->second);
+		openBlocks.erase(found);
+	}
+
+	//Returns the scope index for endScope(), or noScope if the command buffer is not profiled or its block is full
+	uint32_t beginScope(VkCommandBuffer commandBuffer, const char* name, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT) {
+		auto found = openBlocks.find(commandBuffer);
+		if (found == openBlocks.end()) { return noScope; }
+		Block& block = blocks[found->second];
+		if ((block.scopes.size() + 1) * 2 > queriesPerBlock) { droppedScopes++; return noScope; }
+
+		uint32_t scope = static_cast<uint32_t>(block.scopes.size());
+		block.scopes.push_back(name);
+		vkCmdWriteTimestamp(commandBuffer, stage, queryPool, found->second * queriesPerBlock + scope * 2);
+		return scope;
+	}
+
+	void endScope(VkCommandBuffer commandBuffer, uint32_t scope, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT) {
+		auto found = openBlocks.find(commandBuffer);
+		if (scope == noScope || found == openBlocks.end()) { return; }
+		vkCmdWriteTimestamp(commandBuffer, stage, queryPool, found->second * queriesPerBlock + scope * 2 + 1);
+	}
+
+	//Reads back every submitted block whose queries are all available and frees it, never waits on the GPU
+	void collect() {
+		for (size_t i = 0; i < pendingBlocks.size(); ) {
+			uint32_t blockIndex = pendingBlocks[i];
+			Block& block = blocks[blockIndex];
+			uint32_t queryCount = static_cast<uint32_t>(block.scopes.size()) * 2;
+			std::vector<uint64_t> values(queryCount * 2); //Value and availability per query
+			VkResult result = vkGetQueryPoolResults(device, queryPool, blockIndex * queriesPerBlock, queryCount, values.size() * sizeof(uint64_t), values.data(),
+				2 * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+			if (result != VK_SUCCESS && result != VK_NOT_READY) { throw std::runtime_error("failed to read timestamp queries!"); }
+
+			bool available = true;
+			for (uint32_t query = 0; query < queryCount; query++) { available = available && values[query * 2 + 1] != 0; }
+			if (!available) { i++; continue; }
+
+			uint64_t mask = block.validBits >= 64 ? ~0ull : (1ull << block.validBits) - 1;
+			for (uint32_t scope = 0; scope < block.scopes.size(); scope++) {
+				uint64_t begin = values[scope * 4] & mask;
+				uint64_t end = values[scope * 4 + 2] & mask;
+				uint64_t ticks = (end - begin) & mask; //Survives the counter wrapping in between
+				results.push_back({block.scopes[scope], begin * static_cast<double>(period), (begin + ticks) * static_cast<double>(period)});
+			}
+
+			if (hostReset) { vkResetQueryPool(device, queryPool, blockIndex * queriesPerBlock, queriesPerBlock); }
+			freeBlocks.push_back(blockIndex);
+			pendingBlocks.erase(pendingBlocks.begin() + i);
+		}
+	}
+
+	//Timings read back since the last call, outer scope first within a command buffer
+	std::vector<GpuTiming> takeResults() {
+		std::vector<GpuTiming> taken;
+		taken.swap(results);
+		return taken;
+	}
+
+	uint64_t dropped() const { return droppedCommandBuffers + droppedScopes; }
+
+	static constexpr uint32_t noScope = std::numeric_limits<uint32_t>::max();
+
+private:
+	struct Block {
+		uint32_t validBits = 0;
+		std::vector<const char*> scopes;
+	};
+
+	VkDevice device;
+	VkQueryPool queryPool = VK_NULL_HANDLE;
+	float period; //Nanoseconds per tick
+	bool hostReset;
+	uint32_t queriesPerBlock;
+	std::vector<Block> blocks;
+	std::vector<uint32_t> freeBlocks;
+	std::vector<uint32_t> pendingBlocks; //Submitted, oldest first
+	std::unordered_map<VkCommandBuffer, uint32_t> openBlocks; //Being recorded
+	std::vector<GpuTiming> results;
+	uint64_t droppedCommandBuffers = 0;
+	uint64_t droppedScopes = 0;
+};
+
+//Scoped marker, a null profiler makes it a no-op. A scope that is still open when its command buffer ends is never read back, and keeps its block
+class GpuScope {
+public:
+	GpuScope(GpuProfiler* profiler, VkCommandBuffer commandBuffer, const char* name) : profiler(profiler), commandBuffer(commandBuffer) {
+		if (profiler) { scope = profiler->beginScope(commandBuffer, name); }
+	}
+
+	~GpuScope() { end(); }
+
+	//Ends the scope before the destructor would, needed when the command buffer is submitted inside the scope's lifetime
+	void end() {
+		if (profiler) { profiler->endScope(commandBuffer, scope); }
+		profiler = nullptr;
+	}
+
+	GpuScope(const GpuScope&) = delete;
+	GpuScope& operator=(const GpuScope&) = delete;
+
+private:
+	GpuProfiler* profiler;
+	VkCommandBuffer commandBuffer;
+	uint32_t scope = GpuProfiler::noScope;
+};
\ No newline at end of file
@@ -0,0 +1,59 @@
+//GPU timestamps (GPU_PROFILING). Frames, upload batches and mipmap generation are bracketed in their command buffers, collectGpuTimings() picks the
+//results up a few frames later without waiting and keeps them in lastGpuTimings, where the frame benchmark adds them to its report
+void createGpuProfiler() {
+	if (!GPU_PROFILING) { return; }
+
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+	//Families that cannot reset queries in a command buffer are only profiled with host query reset
+	queueTimestampBits.clear();
+	for (const auto& queueFamily : queueFamilies) {
+		bool canReset = hostQueryReset || (queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+		queueTimestampBits.push_back(canReset ? queueFamily.timestampValidBits : 0);
+	}
+
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	if (queueTimestampBits[queueFamilyIndices.graphicsFamily.value()] == 0) {
+		std::cerr << "GPU profiling disabled, the graphics queue has no timestamps" << std::endl;
+		return;
+	}
+	gpuProfiler = std::make_unique<GpuProfiler>(device, properties.limits.timestampPeriod, hostQueryReset, GPU_PROFILER_BLOCKS, GPU_PROFILER_QUERIES_PER_BLOCK);
+	std::cout << "GPU profiling: " << properties.limits.timestampPeriod << " ns per tick" << (hostQueryReset ? ", host query reset" : "") << std::endl;
+}
+
+void beginGpuProfiling(VkCommandBuffer commandBuffer, uint32_t queueFamily, const char* name) {
+	if (gpuProfiler) { gpuProfiler->begin(commandBuffer, queueTimestampBits[queueFamily], name); }
+}
+
+void endGpuProfiling(VkCommandBuffer commandBuffer) {
+	if (gpuProfiler) { gpuProfiler->end(commandBuffer); }
+}
+
+//Explicit form of GpuScope, for scopes that do not match a C++ block
+uint32_t beginGpuScope(VkCommandBuffer commandBuffer, const char* name) {
+	return gpuProfiler ? gpuProfiler->beginScope(commandBuffer, name) : GpuProfiler::noScope;
+}
+
+void endGpuScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+	if (gpuProfiler) { gpuProfiler->endScope(commandBuffer, scope); }
+}
+
+//Called once per frame, never blocks
+void collectGpuTimings() {
+	if (!gpuProfiler) { return; }
+	gpuProfiler->collect();
+	lastGpuTimings = gpuProfiler->takeResults();
+	if (Trace::enabled()) {
+		for (const GpuTiming& timing : lastGpuTimings) { Trace::gpuComplete(timing.name, static_cast<int64_t>(timing.begin) + gpuClockOffset, static_cast<int64_t>(timing.end) + gpuClockOffset); }
+	}
+}
+
+void destroyGpuProfiler() {
+	if (!gpuProfiler) { return; }
+	collectGpuTimings(); //The device is idle, everything left is available
+	if (gpuProfiler->dropped() > 0) { std::cerr << "GPU profiler ran out of queries " << gpuProfiler->dropped() << " times, raise GPU_PROFILER_BLOCKS or GPU_PROFILER_QUERIES_PER_BLOCK" << std::endl; }
+	gpuProfiler.reset();
+}
\ No newline at end of file
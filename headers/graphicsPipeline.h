@@ -23,10 +23,27 @@ VkShaderModule createShaderModule(const std::vector<char>& code) {
 	return shaderModule;
 }
 
+//Pipeline layout and the fallback pipeline, other permutations come from pipelineLibrary
 void createGraphicsPipeline() {
+	//Pipeline layout, shared by every permutation
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
+	if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) { throw std::runtime_error("failed to create pipeline layout!"); }
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+	graphicsPipeline = buildGraphicsPipeline(fallbackPipelineKey());
+	double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	std::cout << "Graphics pipeline created in " << milliseconds << " ms, " << (pipelineCache == VK_NULL_HANDLE ? "no pipeline cache" : pipelineCacheWarm ? "warm cache" : "cold cache") << std::endl;
+}
+
+//Only reads shared state, so the pipeline compiler calls it from its workers
+VkPipeline buildGraphicsPipeline(const PipelineKey& key) {
 	//Load shader bytecodes
-		auto vertShaderCode = readFile("shaders/vert.spv");
-		auto fragShaderCode = readFile("shaders/frag.spv");
+		auto vertShaderCode = readFile(key.vertexShader);
+		auto fragShaderCode = readFile(key.fragmentShader);
 		//Wrap in VkShaderModule
 			VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
 			VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
@@ -49,14 +66,28 @@ void createGraphicsPipeline() {
 
 	//Fixed functions
 		//Vertex input
-		auto bindingDescription = Vertex::getBindingDescription();
-		auto attributeDescriptions = Vertex::getAttributeDescriptions();
+		std::vector<VkVertexInputBindingDescription> bindingDescriptions;
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+		if (key.vertexFormat == VertexFormat::Quantized) {
+			auto quantizedAttributes = QuantizedVertex::getAttributeDescriptions();
+			bindingDescriptions.push_back(QuantizedVertex::getBindingDescription());
+			attributeDescriptions.assign(quantizedAttributes.begin(), quantizedAttributes.end());
+		} else {
+			auto vertexAttributes = Vertex::getAttributeDescriptions();
+			bindingDescriptions.push_back(Vertex::getBindingDescription());
+			attributeDescriptions.assign(vertexAttributes.begin(), vertexAttributes.end());
+		}
+		if (key.instanced) {
+			auto instanceAttributes = InstanceData::getAttributeDescriptions();
+			bindingDescriptions.push_back(InstanceData::getBindingDescription());
+			attributeDescriptions.insert(attributeDescriptions.end(), instanceAttributes.begin(), instanceAttributes.end());
+		}
 
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 			vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-			vertexInputInfo.vertexBindingDescriptionCount = 1;
+			vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
 			vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-			vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+			vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
 			vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
 		//Input assembly
@@ -78,7 +109,7 @@ void createGraphicsPipeline() {
 			rasterizer.rasterizerDiscardEnable = VK_FALSE;
 			rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
 			rasterizer.lineWidth = 1.0f;
-			rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+			rasterizer.cullMode = key.cullMode;
 			rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
 			rasterizer.depthBiasEnable = VK_FALSE;
 
@@ -86,13 +117,13 @@ void createGraphicsPipeline() {
 		VkPipelineMultisampleStateCreateInfo multisampling{};
 			multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
 			multisampling.sampleShadingEnable = VK_FALSE;
-			multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+			multisampling.rasterizationSamples = key.samples;
 
 		//Depth
 		VkPipelineDepthStencilStateCreateInfo depthStencil{};
 			depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-			depthStencil.depthTestEnable = VK_TRUE; //Specifies if the depth of new fragments should be compared to the depth buffer to see if they should be discarded
-			depthStencil.depthWriteEnable = VK_TRUE; //specifies if the new depth of fragments that pass the depth test should actually be written to the depth buffer
+			depthStencil.depthTestEnable = key.depthTest ? VK_TRUE : VK_FALSE; //Specifies if the depth of new fragments should be compared to the depth buffer to see if they should be discarded
+			depthStencil.depthWriteEnable = key.depthWrite ? VK_TRUE : VK_FALSE; //specifies if the new depth of fragments that pass the depth test should actually be written to the depth buffer
 			depthStencil.depthCompareOp = VK_COMPARE_OP_LESS; //specifies the comparison that is performed to keep or discard fragments. We’re sticking to the convention of lower depth = closer, so the depth of new fragments should be less
 			//depthBoundsTestEnable, minDepthBounds and maxDepthBounds fields are used for the optional depth bound test. Basically, this allows you to only keep fragments that fall within the specified depth range
 			depthStencil.depthBoundsTestEnable = VK_FALSE;
@@ -106,7 +137,13 @@ void createGraphicsPipeline() {
 		//Color blending (per attached framebuffer)
 		VkPipelineColorBlendAttachmentState colorBlendAttachment{};
 			colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-			colorBlendAttachment.blendEnable = VK_FALSE;
+			colorBlendAttachment.blendEnable = key.alphaBlend ? VK_TRUE : VK_FALSE;
+			colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+			colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+			colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+			colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+			colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+			colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 
 		//Color blending (global)
 		VkPipelineColorBlendStateCreateInfo colorBlending{};
@@ -126,14 +163,6 @@ void createGraphicsPipeline() {
 			dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
 			dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
 			dynamicState.pDynamicStates = dynamicStates.data();
-
-		//Pipeline layout
-		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-			pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-			pipelineLayoutInfo.setLayoutCount = 1;
-			pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
-			pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
-		if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) { throw std::runtime_error("failed to create pipeline layout!"); }
 	//------------------------------
 
 	//Finally create graphics pipeline
@@ -153,9 +182,12 @@ void createGraphicsPipeline() {
 		pipelineInfo.renderPass = renderPass;
 		pipelineInfo.subpass = 0;
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
-	if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) { throw std::runtime_error("failed to create graphics pipeline!"); }
+	VkPipeline pipeline;
+	VkResult result = vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline);
 
 	//Destroy shader modules early because they are not needed later
 	vkDestroyShaderModule(device, fragShaderModule, nullptr);
 	vkDestroyShaderModule(device, vertShaderModule, nullptr);
+	if (result != VK_SUCCESS) { throw std::runtime_error("failed to create graphics pipeline!"); }
+	return pipeline;
 }
\ No newline at end of file
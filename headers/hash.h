@@ -0,0 +1,50 @@
+//64-bit content hash (xxHash64 algorithm). Used to key on-disk caches, runs at memory bandwidth so hashing a multi-gigabyte source file is cheap next to parsing it
+
+inline uint64_t rotateLeft64(uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+inline uint64_t readUnaligned64(const unsigned char* p) { uint64_t value; memcpy(&value, p, sizeof(value)); return value; }
+inline uint32_t readUnaligned32(const unsigned char* p) { uint32_t value; memcpy(&value, p, sizeof(value)); return value; }
+
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0) {
+	const uint64_t prime1 = 11400714785074694791ULL;
+	const uint64_t prime2 = 14029467366897019727ULL;
+	const uint64_t prime3 = 1609587929392839161ULL;
+	const uint64_t prime4 = 9650029242287828579ULL;
+	const uint64_t prime5 = 2870177450012600261ULL;
+
+	auto round = [&](uint64_t accumulator, uint64_t input) { return rotateLeft64(accumulator + input * prime2, 31) * prime1; };
+	auto merge = [&](uint64_t accumulator, uint64_t value) { return (accumulator ^ round(0, value)) * prime1 + prime4; };
+
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	const unsigned char* end = p + size;
+	uint64_t hash;
+
+	if (size >= 32) {
+		//Four independent lanes keep the multiplier pipelines busy
+		uint64_t v1 = seed + prime1 + prime2, v2 = seed + prime2, v3 = seed, v4 = seed - prime1;
+		for (; p + 32 <= end; p += 32) {
+			v1 = round(v1, readUnaligned64(p));
+			v2 = round(v2, readUnaligned64(p + 8));
+			v3 = round(v3, readUnaligned64(p + 16));
+			v4 = round(v4, readUnaligned64(p + 24));
+		}
+		hash = rotateLeft64(v1, 1) + rotateLeft64(v2, 7) + rotateLeft64(v3, 12) + rotateLeft64(v4, 18);
+		hash = merge(merge(merge(merge(hash, v1), v2), v3), v4);
+	} else {
+		hash = seed + prime5;
+	}
+	hash += static_cast<uint64_t>(size);
+
+	for (; p + 8 <= end; p += 8) { hash = rotateLeft64(hash ^ round(0, readUnaligned64(p)), 27) * prime1 + prime4; }
+	if (p + 4 <= end) { hash = rotateLeft64(hash ^ (static_cast<uint64_t>(readUnaligned32(p)) * prime1), 23) * prime2 + prime3; p += 4; }
+	for (; p < end; p++) { hash = rotateLeft64(hash ^ (*p * prime5), 11) * prime1; }
+
+	hash ^= hash >> 33;
+	hash *= prime2;
+	hash ^= hash >> 29;
+	hash *= prime3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+inline uint64_t hashString(const std::string& text) { return hashBytes(text.data(), text.size()); }
@@ -0,0 +1,71 @@
+//16-bit index buffers. A mesh with more than 65536 vertices is split into ranges of triangles that each use at most 65536 vertices, every range is drawn with its own vertexOffset
+
+struct IndexRange {
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	int32_t vertexOffset;
+};
+
+//Splits the triangle list greedily in draw order into ranges that use at most 65536 vertices each, and lays out every range's vertices as one contiguous block.
+//Vertices used by several ranges are duplicated into each of them, so this works for any triangle order. Only called for meshes that do not fit already
+inline std::vector<IndexRange> splitIndexRanges16(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+	const uint32_t windowSize = 65536;
+
+	std::vector<IndexRange> ranges;
+	std::vector<Vertex> result;
+	result.reserve(vertices.size());
+	std::vector<uint32_t> rangeOf(vertices.size(), UINT32_MAX), remap(vertices.size());
+
+	IndexRange range{0, 0, 0};
+	for (size_t triangle = 0; triangle + 2 < indices.size(); triangle += 3) {
+		uint32_t rangeId = static_cast<uint32_t>(ranges.size());
+		uint32_t newVertices = 0;
+		for (uint32_t corner = 0; corner < 3; corner++) {
+			uint32_t vertex = indices[triangle + corner];
+			bool repeated = (corner > 0 && vertex == indices[triangle]) || (corner > 1 && vertex == indices[triangle + 1]);
+			if (rangeOf[vertex] != rangeId && !repeated) { newVertices++; }
+		}
+		if (result.size() - static_cast<size_t>(range.vertexOffset) + newVertices > windowSize) {
+			range.indexCount = static_cast<uint32_t>(triangle) - range.firstIndex;
+			ranges.push_back(range);
+			range = IndexRange{static_cast<uint32_t>(triangle), 0, static_cast<int32_t>(result.size())};
+			rangeId++;
+		}
+		for (uint32_t corner = 0; corner < 3; corner++) {
+			uint32_t& index = indices[triangle + corner];
+			if (rangeOf[index] != rangeId) {
+				rangeOf[index] = rangeId;
+				remap[index] = static_cast<uint32_t>(result.size());
+				result.push_back(vertices[index]);
+			}
+			index = remap[index];
+		}
+	}
+	range.indexCount = static_cast<uint32_t>(indices.size()) - range.firstIndex;
+	ranges.push_back(range);
+
+	vertices.swap(result);
+	return ranges;
+}
+
+//Indices relative to the vertexOffset of their range
+inline std::vector<uint16_t> packIndices16(const std::vector<uint32_t>& indices, const std::vector<IndexRange>& ranges) {
+	std::vector<uint16_t> packed(indices.size());
+	for (const IndexRange& range : ranges) {
+		for (uint32_t i = range.firstIndex; i < range.firstIndex + range.indexCount; i++) {
+			packed[i] = static_cast<uint16_t>(indices[i] - static_cast<uint32_t>(range.vertexOffset));
+		}
+	}
+	return packed;
+}
+
+//The parts of the index ranges that fall inside [firstIndex, firstIndex + indexCount), e.g. one level of detail
+inline std::vector<IndexRange> clipIndexRanges(const std::vector<IndexRange>& ranges, uint32_t firstIndex, uint32_t indexCount) {
+	std::vector<IndexRange> clipped;
+	for (const IndexRange& range : ranges) {
+		uint32_t begin = std::max(range.firstIndex, firstIndex);
+		uint32_t end = std::min(range.firstIndex + range.indexCount, firstIndex + indexCount);
+		if (begin < end) { clipped.push_back({begin, end - begin, range.vertexOffset}); }
+	}
+	return clipped;
+}
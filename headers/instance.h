@@ -1,8 +1,8 @@
 std::vector<const char*> getRequiredExtensions() {
 	uint32_t glfwExtensionCount = 0;
-	const char** glfwExtensions;
+	const char** glfwExtensions = nullptr;
 	
-	glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+	if (!HEADLESS) { glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount); } //No surface extensions without a window
 
 	std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
 
@@ -40,7 +40,7 @@ void createInstance() {
 		appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 		appInfo.pEngineName = "No Engine";
 		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		appInfo.apiVersion = VK_API_VERSION_1_0;
+		appInfo.apiVersion = USE_TIMELINE_SEMAPHORES || GPU_PROFILING ? VK_API_VERSION_1_2 : VK_API_VERSION_1_0; //Timeline semaphores and host query reset are core in 1.2
 
 	auto extensions = getRequiredExtensions();
 
@@ -63,5 +63,6 @@ void createInstance() {
 }
 
 void createSurface() {
+	if (HEADLESS) { return; }
 	if (glfwCreateWindowSurface(instance, window, nullptr, &surface) != VK_SUCCESS) { throw std::runtime_error("failed to create window surface!"); }
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+//Instanced rendering (USE_INSTANCING): instanceCount copies of the model on a square grid in the XY plane, one model matrix per instance in a device local vertex buffer
+void createInstanceBuffer() {
+	if (!USE_INSTANCING) { return; }
+
+	//Grid centered on the origin, cells a bit wider than the model's bounding sphere
+	uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(instanceCount))));
+	float spacing = std::max(lodBoundsRadius, 1e-3f) * 2.2f;
+	float start = -(side - 1) * spacing * 0.5f;
+	std::vector<InstanceData> instances(instanceCount);
+	for (uint32_t i = 0; i < instanceCount; i++) {
+		glm::vec3 position(start + (i % side) * spacing, start + (i / side) * spacing, 0.0f);
+		instances[i].model = glm::translate(glm::mat4(1.0f), position);
+	}
+	instanceViewScale = std::max(1.0f, side * spacing * 0.5f / std::max(lodBoundsRadius, 1e-3f));
+
+	VkDeviceSize instanceBufferSize = sizeof(instances[0]) * instances.size();
+
+	//GPU local buffer
+	createBuffer(instanceBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, instanceBuffer, instanceBufferMemory);
+
+	//Transfer from CPU to GPU buffer through the staging ring
+	uploadToBuffer(instanceBuffer, 0, instances.data(), instanceBufferSize);
+}
+
+void cleanupInstanceBuffer() {
+	if (instanceBuffer == VK_NULL_HANDLE) { return; }
+	deferDestroyBuffer(instanceBuffer, instanceBufferMemory); //Frames in flight may still read it
+	instanceBuffer = VK_NULL_HANDLE;
+}
+
+//Every count in INSTANCE_BENCHMARK_COUNTS drawn with one draw per instance and with one instanced draw. CPU submit is recording plus vkQueueSubmit,
+//frame time is the wall time of a whole drawFrame() including the fence wait, so it follows the GPU once the GPU is the bottleneck
+void runInstanceBenchmark() {
+	struct Result {
+		uint32_t instances;
+		bool separate;
+		double submitTime;
+		double frameTime;
+	};
+	std::vector<Result> results;
+	waitForAssets();
+
+	for (uint32_t count : INSTANCE_BENCHMARK_COUNTS) {
+		cleanupInstanceBuffer();
+		instanceCount = count;
+		createInstanceBuffer();
+
+		for (bool separate : {true, false}) {
+			drawInstancesSeparately = separate;
+			for (uint32_t frame = 0; frame < INSTANCE_BENCHMARK_FRAMES / 10; frame++) { pollWindowEvents(); drawFrame(); }
+
+			double submitTime = 0.0;
+			auto startTime = std::chrono::high_resolution_clock::now();
+			for (uint32_t frame = 0; frame < INSTANCE_BENCHMARK_FRAMES; frame++) {
+				pollWindowEvents();
+				drawFrame();
+				submitTime += lastSubmitTime;
+			}
+			vkDeviceWaitIdle(device);
+			auto endTime = std::chrono::high_resolution_clock::now();
+			results.push_back({count, separate, submitTime / INSTANCE_BENCHMARK_FRAMES,
+				std::chrono::duration<double, std::milli>(endTime - startTime).count() / INSTANCE_BENCHMARK_FRAMES});
+		}
+	}
+	drawInstancesSeparately = false;
+
+	std::cout << "Instancing benchmark, " << INSTANCE_BENCHMARK_FRAMES << " frames per run, " << lods[0].indexCount / 3 << " triangles per instance at LOD 0" << std::endl;
+	std::cout << "  instances | draws      | CPU submit ms | frame ms" << std::endl;
+	for (const Result& result : results) {
+		std::cout << "  " << std::setw(9) << result.instances << " | " << std::setw(10) << (result.separate ? result.instances : 1u) << " | "
+			<< std::setw(13) << std::fixed << std::setprecision(3) << result.submitTime << " | " << std::setw(8) << result.frameTime << std::defaultfloat << std::endl;
+	}
+}
@@ -1,4 +1,70 @@
+//Produces the welded and optimized mesh, from the mesh cache if it is valid, otherwise by parsing the OBJ and running optimizeMesh()
 void loadModel() {
+	TraceScope traceScope("loadModel", "assets");
+	auto startTime = std::chrono::high_resolution_clock::now();
+	MeshSourceKey sourceKey = describeMeshSource(MODEL_PATH);
+
+	bool cacheHit = USE_MESH_CACHE && loadMeshCache(sourceKey);
+	if (!cacheHit) {
+		switch (MODEL_LOADER) {
+			case ModelLoader::TinyObj: loadModelTinyObj(); break;
+			case ModelLoader::Parallel: loadModelParallel(); break;
+			case ModelLoader::Mapped: loadModelMapped(); break;
+		}
+	}
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	double seconds = std::chrono::duration<double>(endTime - startTime).count();
+	if (cacheHit) {
+		std::cout << "Loaded " << MODEL_PATH << " from mesh cache in " << seconds * 1000.0 << " ms, " << vertices.size() << " vertices, " << indices.size() << " indices" << std::endl;
+	} else {
+		double megabytes = static_cast<double>(sourceKey.size) / (1024.0 * 1024.0);
+		std::cout << "Loaded " << MODEL_PATH << " (" << megabytes << " MB) in " << seconds * 1000.0 << " ms, " << megabytes / seconds << " MB/s, "
+			<< vertices.size() << " vertices, " << indices.size() << " indices" << std::endl;
+	}
+#ifndef _WIN32
+	//Peak resident set size of the whole process so far, ru_maxrss is reported in kilobytes on Linux
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	double meshMegabytes = static_cast<double>(vertices.size() * sizeof(Vertex) + indices.size() * sizeof(uint32_t)) / (1024.0 * 1024.0);
+	std::cout << "Peak RSS " << usage.ru_maxrss / 1024.0 << " MB, output mesh " << meshMegabytes << " MB" << std::endl;
+#endif
+	if (cacheHit) { return; }
+
+	optimizeMesh();
+	if (USE_MESH_CACHE && !writeMeshCache(meshCachePath(MODEL_PATH), sourceKey, hashMeshSource(MODEL_PATH), meshProcessingKey(), vertices, indices)) {
+		std::cerr << "failed to write mesh cache " << meshCachePath(MODEL_PATH) << std::endl;
+	}
+}
+
+//Settings of the stages whose output the mesh cache stores
+uint64_t meshProcessingKey() {
+	uint64_t key = hashBytes(&OPTIMIZE_MESH, sizeof(OPTIMIZE_MESH));
+	return OPTIMIZE_MESH ? hashBytes(&OVERDRAW_THRESHOLD, sizeof(OVERDRAW_THRESHOLD), key) : key;
+}
+
+//Warm start: copy the optimized arrays out of the mapped cache, no text parsing and no optimization. Returns false if the cache has to be rebuilt
+bool loadMeshCache(const MeshSourceKey& sourceKey) {
+	std::string cachePath = meshCachePath(MODEL_PATH);
+	if (!std::filesystem::exists(cachePath)) { return false; }
+
+	MappedFile cache(cachePath);
+	MeshCacheStatus status = validateMeshCache(cache, sourceKey, meshProcessingKey(), MODEL_PATH, VERIFY_MESH_CACHE_SOURCE);
+	if (status != MeshCacheStatus::Hit) {
+		std::cout << "Mesh cache " << cachePath << (status == MeshCacheStatus::Corrupt ? " is corrupt" : " is stale") << ", rebuilding" << std::endl;
+		return false;
+	}
+
+	MeshCacheHeader header;
+	memcpy(&header, cache.data(), sizeof(header));
+	vertices.resize(static_cast<size_t>(header.vertexCount));
+	indices.resize(static_cast<size_t>(header.indexCount));
+	memcpy(vertices.data(), cache.data() + header.vertexOffset, vertices.size() * sizeof(Vertex));
+	memcpy(indices.data(), cache.data() + header.indexOffset, indices.size() * sizeof(uint32_t));
+	return true;
+}
+
+void loadModelTinyObj() {
 	tinyobj::attrib_t attrib;
 	std::vector<tinyobj::shape_t> shapes;
 	std::vector<tinyobj::material_t> materials;
@@ -8,7 +74,7 @@ void loadModel() {
 		MODEL_PATH.c_str())) {
 		throw std::runtime_error(warn + err);  }
 
-	std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+	VertexWelder welder(vertices, attrib.vertices.size() / 3);
 
 	for (const auto& shape : shapes) {
 		for (const auto& index : shape.mesh.indices) {
@@ -24,11 +90,90 @@ void loadModel() {
 			};
 			vertex.color = {1.0f, 1.0f, 1.0f};
 
-			if (uniqueVertices.count(vertex) == 0) {
-				uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-				vertices.push_back(vertex);
-			}
-			indices.push_back(uniqueVertices[vertex]);
+			indices.push_back(welder.weld(vertex));
 		}
 	}
-}
\ No newline at end of file
+}
+
+void loadModelParallel() {
+	auto startTime = std::chrono::high_resolution_clock::now();
+	MappedFile file(MODEL_PATH);
+	auto mapTime = std::chrono::high_resolution_clock::now();
+
+	//Parse line-aligned chunks on every core. There are more chunks than threads so a chunk full of long face lines does not hold up the others
+	unsigned int threadCount = MODEL_LOADER_THREADS != 0 ? MODEL_LOADER_THREADS : std::max(1u, std::thread::hardware_concurrency());
+	std::vector<ObjChunk> chunks = splitObjChunks(file.data(), file.size(), static_cast<size_t>(threadCount) * 4);
+
+	std::atomic<size_t> nextChunk{0};
+	auto parseChunks = [&chunks, &nextChunk]() {
+		for (size_t i = nextChunk++; i < chunks.size(); i = nextChunk++) { parseObjChunk(chunks[i]); }
+	};
+	std::vector<std::thread> workers;
+	for (unsigned int i = 1; i < threadCount; i++) { workers.emplace_back(parseChunks); }
+	parseChunks();
+	for (auto& worker : workers) { worker.join(); }
+	auto parseTime = std::chrono::high_resolution_clock::now();
+
+	//Concatenate the chunk arrays in file order and turn chunk-local relative indices into global ones
+	size_t positionCount = 0, texcoordCount = 0, cornerCount = 0;
+	for (const auto& chunk : chunks) {
+		positionCount += chunk.positions.size();
+		texcoordCount += chunk.texcoords.size();
+		cornerCount += chunk.corners.size();
+	}
+	std::vector<float> positions, texcoords;
+	std::vector<ObjCorner> corners;
+	positions.reserve(positionCount);
+	texcoords.reserve(texcoordCount);
+	corners.reserve(cornerCount);
+
+	for (auto& chunk : chunks) {
+		int32_t positionOffset = static_cast<int32_t>(positions.size() / 3);
+		int32_t texcoordOffset = static_cast<int32_t>(texcoords.size() / 2);
+		for (uint32_t corner : chunk.relativePositions) { chunk.corners[corner].position += positionOffset; }
+		for (uint32_t corner : chunk.relativeTexcoords) { chunk.corners[corner].texcoord += texcoordOffset; }
+
+		positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+		texcoords.insert(texcoords.end(), chunk.texcoords.begin(), chunk.texcoords.end());
+		corners.insert(corners.end(), chunk.corners.begin(), chunk.corners.end());
+		chunk = ObjChunk();
+	}
+
+	//Deduplicate on all cores, the vertex order still matches the tinyobj path
+	for (const ObjCorner& corner : corners) { checkObjCorner(positions, texcoords, corner); } //Throw here, not on a worker thread
+	weldVerticesParallel(corners.size(), [&](size_t i) { return makeObjVertex(positions, texcoords, corners[i]); }, threadCount, vertices, indices);
+	auto mergeTime = std::chrono::high_resolution_clock::now();
+
+	auto milliseconds = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+	double parseSeconds = milliseconds(mapTime, parseTime) / 1000.0;
+	std::cout << "Parallel OBJ load: " << threadCount << " threads, " << chunks.size() << " chunks | map " << milliseconds(startTime, mapTime)
+		<< " ms, parse " << milliseconds(mapTime, parseTime) << " ms (" << file.size() / (1024.0 * 1024.0) / parseSeconds << " MB/s), merge "
+		<< milliseconds(parseTime, mergeTime) << " ms" << std::endl;
+}
+
+//Streams the memory-mapped file straight into vertices/indices. Only the position and texcoord arrays are kept besides the output, there is no copy of the file and no per-face container
+void loadModelMapped() {
+	MappedFile file(MODEL_PATH);
+	file.adviseSequential();
+
+	struct MeshSink {
+		std::vector<Vertex>& vertices;
+		std::vector<uint32_t>& indices;
+		std::vector<float> positions{};
+		std::vector<float> texcoords{};
+		VertexWelder welder{vertices};
+
+		void position(float x, float y, float z) { positions.insert(positions.end(), {x, y, z}); }
+		void texcoord(float u, float v) { texcoords.insert(texcoords.end(), {u, v}); }
+		void corner(ObjCorner corner) {
+			bool relative = false;
+			corner.position = resolveObjIndex(corner.position, positions.size() / 3, relative);
+			if (corner.hasTexcoord) { corner.texcoord = resolveObjIndex(corner.texcoord, texcoords.size() / 2, relative); }
+
+			indices.push_back(welder.weld(makeObjVertex(positions, texcoords, corner)));
+		}
+	};
+
+	MeshSink sink{vertices, indices};
+	parseObjLines(file.data(), file.data() + file.size(), sink);
+}
@@ -0,0 +1,57 @@
+//Level of detail chain. Every level is appended to indices and indexes the same vertices, lods[0] is the full mesh
+void createLods() {
+	lods = {{0, static_cast<uint32_t>(indices.size()), 0.0f}};
+
+	glm::vec3 minimum(std::numeric_limits<float>::max()), maximum(-std::numeric_limits<float>::max());
+	for (const Vertex& vertex : vertices) {
+		minimum = glm::min(minimum, vertex.pos);
+		maximum = glm::max(maximum, vertex.pos);
+	}
+	lodBoundsCenter = vertices.empty() ? glm::vec3(0.0f) : (minimum + maximum) * 0.5f;
+	lodBoundsRadius = vertices.empty() ? 0.0f : glm::length(maximum - minimum) * 0.5f;
+	if (!GENERATE_LODS) { return; }
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+	std::vector<uint32_t> fullMesh = indices;
+	for (float ratio : LOD_TARGET_RATIOS) {
+		size_t targetIndexCount = static_cast<size_t>(fullMesh.size() / 3 * ratio) * 3;
+		float error;
+		std::vector<uint32_t> lodIndices = simplifyMesh(vertices, fullMesh, targetIndexCount, error);
+		if (lodIndices.size() >= lods.back().indexCount) { break; } //Nothing left that can collapse
+		optimizeVertexCache(lodIndices, vertices.size());
+
+		lods.push_back({static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(lodIndices.size()), error});
+		indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+	}
+	auto endTime = std::chrono::high_resolution_clock::now();
+
+	std::cout << "Generated " << lods.size() - 1 << " LODs in " << std::chrono::duration<double, std::milli>(endTime - startTime).count() << " ms" << std::endl;
+	for (size_t i = 0; i < lods.size(); i++) {
+		std::cout << "  LOD " << i << ": " << lods[i].indexCount / 3 << " triangles (" << 100.0 * lods[i].indexCount / lods[0].indexCount << "%), error "
+			<< lods[i].error << " (" << (lodBoundsRadius > 0.0f ? lods[i].error / lodBoundsRadius * 100.0f : 0.0f) << "% of bounding radius)" << std::endl;
+	}
+}
+
+//Coarsest level whose error, projected at the nearest point of the bounding sphere, stays under LOD_ERROR_THRESHOLD pixels. Levels coarser than the
+//current one have to stay under LOD_HYSTERESIS times the threshold
+uint32_t selectLod(const UniformBufferObject& ubo) {
+	glm::vec3 center = glm::vec3(ubo.view * ubo.model * glm::vec4(lodBoundsCenter, 1.0f));
+	float distance = std::max(glm::length(center) - lodBoundsRadius, 1e-3f);
+	float pixelsPerUnit = std::abs(ubo.proj[1][1]) * swapChainExtent.height * 0.5f / distance;
+
+	uint32_t selected = 0;
+	for (uint32_t i = 1; i < lods.size(); i++) {
+		float threshold = i > currentLod ? LOD_ERROR_THRESHOLD * LOD_HYSTERESIS : LOD_ERROR_THRESHOLD;
+		if (lods[i].error * pixelsPerUnit <= threshold) { selected = i; }
+	}
+	if (selected != currentLod) {
+		lodSwitches++;
+		currentLod = selected;
+	}
+	return selected;
+}
+
+void reportLodStats() {
+	if (lods.size() < 2) { return; }
+	std::cout << "LOD: " << lodSwitches << " switches, ended on level " << currentLod << " of " << lods.size() << std::endl;
+}
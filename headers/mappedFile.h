@@ -0,0 +1,91 @@
+//Read-only memory mapping of a whole file. Pages are loaded on demand by the OS and never copied into the process heap
+class MappedFile {
+public:
+	MappedFile() = default;
+	explicit MappedFile(const std::string& path) { open(path); }
+	~MappedFile() { close(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	void open(const std::string& path) {
+		close();
+#ifdef _WIN32
+		fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE) { throw std::runtime_error("failed to open file!"); }
+		LARGE_INTEGER fileSize;
+		GetFileSizeEx(fileHandle, &fileSize);
+		mappedSize = static_cast<size_t>(fileSize.QuadPart);
+		if (mappedSize == 0) { return; }
+		mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mappingHandle == nullptr) { close(); throw std::runtime_error("failed to map file!"); }
+		mappedData = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if (mappedData == nullptr) { close(); throw std::runtime_error("failed to map file!"); }
+#else
+		fileDescriptor = ::open(path.c_str(), O_RDONLY);
+		if (fileDescriptor < 0) { throw std::runtime_error("failed to open file!"); }
+		struct stat fileStat;
+		if (fstat(fileDescriptor, &fileStat) != 0) { close(); throw std::runtime_error("failed to open file!"); }
+		mappedSize = static_cast<size_t>(fileStat.st_size);
+		if (mappedSize == 0) { return; }
+		void* mapping = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		if (mapping == MAP_FAILED) { close(); throw std::runtime_error("failed to map file!"); }
+		mappedData = static_cast<const char*>(mapping);
+#endif
+	}
+
+	void close() {
+#ifdef _WIN32
+		if (mappedData != nullptr) { UnmapViewOfFile(mappedData); }
+		if (mappingHandle != nullptr) { CloseHandle(mappingHandle); }
+		if (fileHandle != INVALID_HANDLE_VALUE) { CloseHandle(fileHandle); }
+		mappingHandle = nullptr;
+		fileHandle = INVALID_HANDLE_VALUE;
+#else
+		if (mappedData != nullptr) { munmap(const_cast<char*>(mappedData), mappedSize); }
+		if (fileDescriptor >= 0) { ::close(fileDescriptor); }
+		fileDescriptor = -1;
+#endif
+		mappedData = nullptr;
+		mappedSize = 0;
+	}
+
+	//Hint that the mapping is read front to back once, so the OS can read ahead and drop pages behind us
+	void adviseSequential() const {
+#ifndef _WIN32
+		if (mappedData != nullptr) { madvise(const_cast<char*>(mappedData), mappedSize, MADV_SEQUENTIAL); }
+#endif
+	}
+
+	const char* data() const { return mappedData; }
+	size_t size() const { return mappedSize; }
+
+private:
+	const char* mappedData = nullptr;
+	size_t mappedSize = 0;
+#ifdef _WIN32
+	HANDLE fileHandle = INVALID_HANDLE_VALUE;
+	HANDLE mappingHandle = nullptr;
+#else
+	int fileDescriptor = -1;
+#endif
+};
+
+//Writes a file through a temporary next to it that is renamed over the old one, so readers never see a half written file and a crash leaves the old
+//one in place. writeContents(std::ofstream&) fills the file. Returns false instead of throwing, every caller writes a cache that is only an optimization
+template<typename WriteContents>
+inline bool writeFileAtomically(const std::string& path, WriteContents writeContents) {
+	std::string temporaryPath = path + ".tmp";
+	bool written;
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) { return false; }
+		writeContents(file);
+		written = static_cast<bool>(file.flush());
+	}
+
+	std::error_code error;
+	if (written) { std::filesystem::rename(temporaryPath, path, error); }
+	if (!written || error) { std::filesystem::remove(temporaryPath, error); return false; }
+	return true;
+}
@@ -0,0 +1,374 @@
+//Device memory sub-allocation. Large blocks are reserved per memory type and split up by a TLSF allocator, so resources no longer cost one
+//vkAllocateMemory each and stay far below maxMemoryAllocationCount. MemoryAllocator only reaches the device through MemoryBackend, so it runs
+//just as well against a mock that hands out fake VkDeviceMemory handles
+
+inline uint32_t highestSetBit(uint64_t value) {
+	uint32_t bit = 0;
+	while (value >>= 1) { bit++; }
+	return bit;
+}
+
+inline uint32_t lowestSetBit(uint64_t value) {
+	uint32_t bit = 0;
+	while (!(value & 1)) { value >>= 1; bit++; }
+	return bit;
+}
+
+inline uint64_t alignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+//Two level segregated fit (Masmano et al. 2004) over the bytes of one block. Free ranges are binned by size class, so allocate and free are O(1)
+//apart from the alignment handling. Only does offset bookkeeping, never touches the memory itself
+class TlsfAllocator {
+public:
+	explicit TlsfAllocator(uint64_t size) : blockSize(size) {
+		for (auto& heads : freeHeads) { heads.fill(NONE); }
+		insertFree(createRange({0, size, NONE, NONE, NONE, NONE, true}));
+	}
+
+	//Returns false if no free range can hold size bytes at the alignment
+	bool allocate(uint64_t size, uint64_t alignment, uint64_t& offset) {
+		if (size == 0 || size > blockSize || alignment == 0) { return false; }
+		//The first range large enough usually is aligned already, only search for room for the worst case padding when it is not
+		uint32_t firstLevel, secondLevel;
+		bool found = findFree(size, firstLevel, secondLevel);
+		if (found) {
+			const Range& candidate = ranges[freeHeads[firstLevel][secondLevel]];
+			found = alignUp(candidate.offset, alignment) + size <= candidate.offset + candidate.size;
+		}
+		uint32_t index = NONE;
+		if (found || findFree(size + alignment - 1, firstLevel, secondLevel)) { index = freeHeads[firstLevel][secondLevel]; }
+		else { index = findInSizeClass(size, alignment); } //A range only just large enough, like the whole of a dedicated block, is in the class of size itself
+		if (index == NONE) { return false; }
+		removeFree(index);
+
+		//Return the alignment padding in front and whatever is left behind to the free lists. Both neighbours are in use, free ranges never touch
+		uint64_t alignedOffset = alignUp(ranges[index].offset, alignment);
+		if (alignedOffset > ranges[index].offset) {
+			uint32_t front = createRange({ranges[index].offset, alignedOffset - ranges[index].offset, ranges[index].previousPhysical, index, NONE, NONE, true});
+			if (ranges[front].previousPhysical != NONE) { ranges[ranges[front].previousPhysical].nextPhysical = front; }
+			ranges[index].previousPhysical = front;
+			ranges[index].offset = alignedOffset;
+			ranges[index].size -= ranges[front].size;
+			insertFree(front);
+		}
+		if (ranges[index].size > size) {
+			uint32_t back = createRange({alignedOffset + size, ranges[index].size - size, index, ranges[index].nextPhysical, NONE, NONE, true});
+			if (ranges[back].nextPhysical != NONE) { ranges[ranges[back].nextPhysical].previousPhysical = back; }
+			ranges[index].nextPhysical = back;
+			ranges[index].size = size;
+			insertFree(back);
+		}
+
+		ranges[index].free = false;
+		allocated[alignedOffset] = index;
+		usedBytes += size;
+		offset = alignedOffset;
+		return true;
+	}
+
+	//Merges the range with free neighbours right away, so two free ranges are never adjacent
+	void free(uint64_t offset) {
+		auto allocation = allocated.find(offset);
+		if (allocation == allocated.end()) { throw std::runtime_error("failed to free memory range that was never allocated!"); }
+		uint32_t index = allocation->second;
+		allocated.erase(allocation);
+		usedBytes -= ranges[index].size;
+		ranges[index].free = true;
+
+		uint32_t next = ranges[index].nextPhysical;
+		if (next != NONE && ranges[next].free) {
+			removeFree(next);
+			ranges[index].size += ranges[next].size;
+			ranges[index].nextPhysical = ranges[next].nextPhysical;
+			if (ranges[index].nextPhysical != NONE) { ranges[ranges[index].nextPhysical].previousPhysical = index; }
+			releaseRange(next);
+		}
+		uint32_t previous = ranges[index].previousPhysical;
+		if (previous != NONE && ranges[previous].free) {
+			removeFree(previous);
+			ranges[previous].size += ranges[index].size;
+			ranges[previous].nextPhysical = ranges[index].nextPhysical;
+			if (ranges[previous].nextPhysical != NONE) { ranges[ranges[previous].nextPhysical].previousPhysical = previous; }
+			releaseRange(index);
+			index = previous;
+		}
+		insertFree(index);
+	}
+
+	uint64_t size() const { return blockSize; }
+	uint64_t used() const { return usedBytes; }
+	size_t allocationCount() const { return allocated.size(); }
+	size_t freeRangeCount() const { return ranges.size() - unusedRanges.size() - allocated.size(); }
+
+	uint64_t largestFreeRange() const {
+		if (firstLevelBitmap == 0) { return 0; }
+		uint32_t firstLevel = highestSetBit(firstLevelBitmap);
+		uint64_t largest = 0;
+		for (uint32_t index = freeHeads[firstLevel][highestSetBit(secondLevelBitmaps[firstLevel])]; index != NONE; index = ranges[index].nextFree) {
+			largest = std::max(largest, ranges[index].size);
+		}
+		return largest;
+	}
+
+private:
+	static constexpr uint32_t NONE = UINT32_MAX;
+	static constexpr uint32_t SECOND_LEVEL_BITS = 4;
+	static constexpr uint32_t SECOND_LEVEL_COUNT = 1 << SECOND_LEVEL_BITS;
+	static constexpr uint32_t FIRST_LEVEL_COUNT = 64;
+
+	struct Range {
+		uint64_t offset;
+		uint64_t size;
+		uint32_t previousPhysical; //Neighbours by address
+		uint32_t nextPhysical;
+		uint32_t previousFree; //Neighbours in the free list of the size class, only while free
+		uint32_t nextFree;
+		bool free;
+	};
+
+	uint64_t blockSize;
+	uint64_t usedBytes = 0;
+	std::vector<Range> ranges;
+	std::vector<uint32_t> unusedRanges;
+	std::unordered_map<uint64_t, uint32_t> allocated; //Offset to range
+	uint64_t firstLevelBitmap = 0;
+	std::array<uint32_t, FIRST_LEVEL_COUNT> secondLevelBitmaps{};
+	std::array<std::array<uint32_t, SECOND_LEVEL_COUNT>, FIRST_LEVEL_COUNT> freeHeads;
+
+	//Sizes below SECOND_LEVEL_COUNT share first level 0, above that each power of two is split into SECOND_LEVEL_COUNT linear steps
+	static void mapping(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel) {
+		if (size < SECOND_LEVEL_COUNT) {
+			firstLevel = 0;
+			secondLevel = static_cast<uint32_t>(size);
+			return;
+		}
+		uint32_t log = highestSetBit(size);
+		firstLevel = log - SECOND_LEVEL_BITS + 1;
+		secondLevel = static_cast<uint32_t>(size >> (log - SECOND_LEVEL_BITS)) - SECOND_LEVEL_COUNT;
+	}
+
+	//Rounds the size up to the next size class first, so every range in the list that is found is large enough
+	bool findFree(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel) const {
+		if (size >= SECOND_LEVEL_COUNT) { size += (1ull << (highestSetBit(size) - SECOND_LEVEL_BITS)) - 1; }
+		mapping(size, firstLevel, secondLevel);
+		if (firstLevel >= FIRST_LEVEL_COUNT) { return false; }
+
+		uint32_t secondLevelMap = secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+		if (secondLevelMap == 0) {
+			uint64_t firstLevelMap = firstLevel + 1 < FIRST_LEVEL_COUNT ? firstLevelBitmap & (~0ull << (firstLevel + 1)) : 0;
+			if (firstLevelMap == 0) { return false; }
+			firstLevel = lowestSetBit(firstLevelMap);
+			secondLevelMap = secondLevelBitmaps[firstLevel];
+		}
+		secondLevel = lowestSetBit(secondLevelMap);
+		return true;
+	}
+
+	//Walks the free list of the size class size falls into, returns NONE if no range in it fits
+	uint32_t findInSizeClass(uint64_t size, uint64_t alignment) const {
+		uint32_t firstLevel, secondLevel;
+		mapping(size, firstLevel, secondLevel);
+		if (firstLevel >= FIRST_LEVEL_COUNT) { return NONE; }
+		for (uint32_t index = freeHeads[firstLevel][secondLevel]; index != NONE; index = ranges[index].nextFree) {
+			if (alignUp(ranges[index].offset, alignment) + size <= ranges[index].offset + ranges[index].size) { return index; }
+		}
+		return NONE;
+	}
+
+	void insertFree(uint32_t index) {
+		uint32_t firstLevel, secondLevel;
+		mapping(ranges[index].size, firstLevel, secondLevel);
+		ranges[index].free = true;
+		ranges[index].previousFree = NONE;
+		ranges[index].nextFree = freeHeads[firstLevel][secondLevel];
+		if (ranges[index].nextFree != NONE) { ranges[ranges[index].nextFree].previousFree = index; }
+		freeHeads[firstLevel][secondLevel] = index;
+		firstLevelBitmap |= 1ull << firstLevel;
+		secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+	}
+
+	void removeFree(uint32_t index) {
+		uint32_t firstLevel, secondLevel;
+		mapping(ranges[index].size, firstLevel, secondLevel);
+		if (ranges[index].previousFree != NONE) { ranges[ranges[index].previousFree].nextFree = ranges[index].nextFree; }
+		else { freeHeads[firstLevel][secondLevel] = ranges[index].nextFree; }
+		if (ranges[index].nextFree != NONE) { ranges[ranges[index].nextFree].previousFree = ranges[index].previousFree; }
+
+		if (freeHeads[firstLevel][secondLevel] == NONE) {
+			secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+			if (secondLevelBitmaps[firstLevel] == 0) { firstLevelBitmap &= ~(1ull << firstLevel); }
+		}
+	}
+
+	uint32_t createRange(const Range& range) {
+		if (!unusedRanges.empty()) {
+			uint32_t index = unusedRanges.back();
+			unusedRanges.pop_back();
+			ranges[index] = range;
+			return index;
+		}
+		ranges.push_back(range);
+		return static_cast<uint32_t>(ranges.size() - 1);
+	}
+
+	void releaseRange(uint32_t index) { unusedRanges.push_back(index); }
+};
+
+//How MemoryAllocator reaches the device. allocate returns VK_NULL_HANDLE on failure, map is only called for host visible memory types
+struct MemoryBackend {
+	std::function<VkDeviceMemory(uint32_t memoryTypeIndex, VkDeviceSize size)> allocate;
+	std::function<void(VkDeviceMemory memory)> free;
+	std::function<void*(VkDeviceMemory memory)> map;
+};
+
+struct MemoryAllocation {
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkDeviceSize offset = 0;
+	VkDeviceSize size = 0; //Including the bufferImageGranularity padding of optimal tiling images
+	VkDeviceSize requestedSize = 0;
+	void* mapped = nullptr; //Host visible blocks stay mapped for their whole lifetime
+	uint32_t block = 0;
+};
+
+struct MemoryAllocatorStats {
+	size_t blockCount;
+	size_t dedicatedBlockCount;
+	size_t allocationCount;
+	uint64_t deviceAllocations; //vkAllocateMemory calls so far
+	uint64_t reservedBytes; //Sum of all blocks
+	uint64_t usedBytes;
+	uint64_t wastedBytes; //Used but not requested, i.e. granularity padding
+	uint64_t largestFreeRange;
+	size_t freeRangeCount;
+	double fragmentation; //1 - largest free range / free bytes, averaged over the blocks weighted by their free bytes
+};
+
+class MemoryAllocator {
+public:
+	//memoryTypeFlags holds the property flags of every memory type, index for index
+	MemoryAllocator(MemoryBackend memoryBackend, std::vector<VkMemoryPropertyFlags> memoryTypeFlags, VkDeviceSize defaultBlockSize, VkDeviceSize bufferImageGranularity)
+		: backend(std::move(memoryBackend)), typeFlags(std::move(memoryTypeFlags)), blockSize(defaultBlockSize), granularity(std::max<VkDeviceSize>(bufferImageGranularity, 1)) {}
+
+	MemoryAllocator(const MemoryAllocator&) = delete;
+	MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+	~MemoryAllocator() {
+		for (const auto& block : blocks) {
+			if (block) { backend.free(block->memory); }
+		}
+	}
+
+	//Linear resources (buffers) and optimal tiling images must not share a bufferImageGranularity page. Optimal images get whole pages to
+	//themselves by aligning both ends to the granularity, so buffers can pack freely around them
+	MemoryAllocation allocate(const VkMemoryRequirements& requirements, uint32_t memoryTypeIndex, bool optimalTiling) {
+		VkDeviceSize size = requirements.size;
+		VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+		if (optimalTiling && granularity > 1) {
+			size = alignUp(size, granularity);
+			alignment = std::max(alignment, granularity);
+		}
+
+		MemoryAllocation allocation{};
+			allocation.size = size;
+			allocation.requestedSize = requirements.size;
+
+		//Anything over half a block gets a block of its own that is released together with the resource
+		bool dedicated = size > blockSize / 2;
+		if (!dedicated) {
+			for (uint32_t i = 0; i < blocks.size(); i++) {
+				if (blocks[i] && !blocks[i]->dedicated && blocks[i]->memoryTypeIndex == memoryTypeIndex && suballocate(i, alignment, allocation)) { return allocation; }
+			}
+		}
+
+		VkDeviceSize newBlockSize = dedicated ? size : blockSize;
+		uint32_t block = createBlock(memoryTypeIndex, newBlockSize, dedicated);
+		if (block == UINT32_MAX && !dedicated) {
+			//Not enough room for a whole block, try one that only fits this resource
+			dedicated = true;
+			block = createBlock(memoryTypeIndex, size, true);
+		}
+		if (block == UINT32_MAX || !suballocate(block, alignment, allocation)) { throw std::runtime_error("failed to allocate device memory!"); }
+		return allocation;
+	}
+
+	void free(MemoryAllocation& allocation) {
+		if (allocation.memory == VK_NULL_HANDLE) { return; }
+		Block& block = *blocks[allocation.block];
+		block.ranges.free(allocation.offset);
+		requestedBytes -= allocation.requestedSize;
+		if (block.dedicated) {
+			backend.free(block.memory);
+			blocks[allocation.block].reset();
+		}
+		allocation = MemoryAllocation{};
+	}
+
+	MemoryAllocatorStats getStats() const {
+		MemoryAllocatorStats stats{};
+		stats.deviceAllocations = deviceAllocations;
+		double weightedFragmentation = 0.0;
+		uint64_t freeBytes = 0;
+		for (const auto& block : blocks) {
+			if (!block) { continue; }
+			stats.blockCount++;
+			stats.dedicatedBlockCount += block->dedicated;
+			stats.allocationCount += block->ranges.allocationCount();
+			stats.reservedBytes += block->ranges.size();
+			stats.usedBytes += block->ranges.used();
+			stats.freeRangeCount += block->ranges.freeRangeCount();
+
+			uint64_t blockFree = block->ranges.size() - block->ranges.used();
+			uint64_t largest = block->ranges.largestFreeRange();
+			stats.largestFreeRange = std::max(stats.largestFreeRange, largest);
+			if (blockFree > 0) { weightedFragmentation += (1.0 - static_cast<double>(largest) / blockFree) * blockFree; }
+			freeBytes += blockFree;
+		}
+		stats.wastedBytes = stats.usedBytes - requestedBytes;
+		stats.fragmentation = freeBytes > 0 ? weightedFragmentation / freeBytes : 0.0;
+		return stats;
+	}
+
+private:
+	struct Block {
+		VkDeviceMemory memory;
+		void* mapped;
+		uint32_t memoryTypeIndex;
+		bool dedicated;
+		TlsfAllocator ranges;
+	};
+
+	MemoryBackend backend;
+	std::vector<VkMemoryPropertyFlags> typeFlags;
+	VkDeviceSize blockSize;
+	VkDeviceSize granularity;
+	std::vector<std::unique_ptr<Block>> blocks; //Released dedicated blocks leave an empty slot, so the indices in MemoryAllocation stay valid
+	uint64_t deviceAllocations = 0;
+	uint64_t requestedBytes = 0;
+
+	//Returns UINT32_MAX if the device is out of memory
+	uint32_t createBlock(uint32_t memoryTypeIndex, VkDeviceSize size, bool dedicated) {
+		VkDeviceMemory memory = backend.allocate(memoryTypeIndex, size);
+		if (memory == VK_NULL_HANDLE) { return UINT32_MAX; }
+		deviceAllocations++;
+		void* mapped = (typeFlags[memoryTypeIndex] & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) ? backend.map(memory) : nullptr;
+
+		auto block = std::unique_ptr<Block>(new Block{memory, mapped, memoryTypeIndex, dedicated, TlsfAllocator(size)});
+		for (uint32_t i = 0; i < blocks.size(); i++) {
+			if (!blocks[i]) { blocks[i] = std::move(block); return i; }
+		}
+		blocks.push_back(std::move(block));
+		return static_cast<uint32_t>(blocks.size() - 1);
+	}
+
+	bool suballocate(uint32_t blockIndex, VkDeviceSize alignment, MemoryAllocation& allocation) {
+		Block& block = *blocks[blockIndex];
+		VkDeviceSize offset;
+		if (!block.ranges.allocate(allocation.size, alignment, offset)) { return false; }
+		allocation.memory = block.memory;
+		allocation.offset = offset;
+		allocation.mapped = block.mapped ? static_cast<char*>(block.mapped) + offset : nullptr;
+		allocation.block = blockIndex;
+		requestedBytes += allocation.requestedSize;
+		return true;
+	}
+};
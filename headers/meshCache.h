@@ -0,0 +1,109 @@
+//On-disk cache of the mesh produced by loadModel(), welded and run through optimizeMesh(). LODs, index ranges, quantization and meshlets are built from it
+//on every start. Layout: MeshCacheHeader | padding | Vertex[vertexCount] | uint32_t[indexCount], both arrays 16 byte aligned
+
+const uint32_t MESH_CACHE_MAGIC = 0x434D4B56; //"VKMC"
+const uint32_t MESH_CACHE_VERSION = 2;
+
+struct MeshCacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t vertexStride;
+	uint32_t indexStride;
+
+	//Source file key
+	uint64_t pathHash;
+	uint64_t sourceSize;
+	int64_t sourceModifiedTime;
+	uint64_t sourceHash;
+	uint64_t processingKey; //Settings of the stages baked into the payload, a different key makes the cache stale
+
+	//Payload
+	uint64_t vertexCount;
+	uint64_t indexCount;
+	uint64_t vertexOffset;
+	uint64_t indexOffset;
+	uint64_t payloadHash; //Detects truncated or corrupted files
+};
+
+struct MeshSourceKey {
+	uint64_t pathHash;
+	uint64_t size;
+	int64_t modifiedTime;
+};
+
+inline std::string meshCachePath(const std::string& sourcePath) { return sourcePath + ".meshcache"; }
+
+inline uint64_t alignMeshCacheOffset(uint64_t offset) { return (offset + 15) & ~uint64_t(15); }
+
+inline MeshSourceKey describeMeshSource(const std::string& sourcePath) {
+	MeshSourceKey key{};
+		key.pathHash = hashString(std::filesystem::absolute(sourcePath).generic_string());
+		key.size = static_cast<uint64_t>(std::filesystem::file_size(sourcePath));
+		key.modifiedTime = static_cast<int64_t>(std::filesystem::last_write_time(sourcePath).time_since_epoch().count());
+	return key;
+}
+
+inline uint64_t hashMeshSource(const std::string& sourcePath) {
+	MappedFile source(sourcePath);
+	source.adviseSequential();
+	return hashBytes(source.data(), source.size());
+}
+
+enum class MeshCacheStatus { Hit, Stale, Corrupt };
+
+//Validates the mapped cache against the source file. On a hit the vertex and index arrays can be read at header->vertexOffset / header->indexOffset.
+//verifySource also hashes the whole source, which catches copied or restored files that keep old timestamps but costs a full read of the OBJ
+inline MeshCacheStatus validateMeshCache(const MappedFile& cache, const MeshSourceKey& key, uint64_t processingKey, const std::string& sourcePath, bool verifySource) {
+	if (cache.size() < sizeof(MeshCacheHeader)) { return MeshCacheStatus::Corrupt; }
+
+	MeshCacheHeader header;
+	memcpy(&header, cache.data(), sizeof(header));
+	if (header.magic != MESH_CACHE_MAGIC) { return MeshCacheStatus::Corrupt; }
+	if (header.version != MESH_CACHE_VERSION || header.vertexStride != sizeof(Vertex) || header.indexStride != sizeof(uint32_t)) { return MeshCacheStatus::Stale; }
+	if (header.pathHash != key.pathHash || header.sourceSize != key.size || header.sourceModifiedTime != key.modifiedTime) { return MeshCacheStatus::Stale; }
+	if (header.processingKey != processingKey) { return MeshCacheStatus::Stale; }
+
+	//Every value is bounded by the file size before it is multiplied or added, so a damaged header cannot wrap around into a range that passes
+	uint64_t cacheSize = cache.size();
+	if (header.vertexCount > cacheSize / sizeof(Vertex) || header.indexCount > cacheSize / sizeof(uint32_t)) { return MeshCacheStatus::Corrupt; }
+	uint64_t vertexBytes = header.vertexCount * sizeof(Vertex);
+	uint64_t indexBytes = header.indexCount * sizeof(uint32_t);
+	if (header.vertexOffset < sizeof(MeshCacheHeader) || header.vertexOffset > cacheSize || vertexBytes > cacheSize - header.vertexOffset ||
+		header.indexOffset < header.vertexOffset + vertexBytes || header.indexOffset > cacheSize || indexBytes != cacheSize - header.indexOffset) { return MeshCacheStatus::Corrupt; }
+
+	uint64_t payloadHash = hashBytes(cache.data() + header.vertexOffset, static_cast<size_t>(vertexBytes));
+	payloadHash = hashBytes(cache.data() + header.indexOffset, static_cast<size_t>(indexBytes), payloadHash);
+	if (payloadHash != header.payloadHash) { return MeshCacheStatus::Corrupt; }
+
+	if (verifySource && hashMeshSource(sourcePath) != header.sourceHash) { return MeshCacheStatus::Stale; }
+	return MeshCacheStatus::Hit;
+}
+
+//Returns false if the cache could not be written
+inline bool writeMeshCache(const std::string& cachePath, const MeshSourceKey& key, uint64_t sourceHash, uint64_t processingKey, const std::vector<Vertex>& vertices,
+	const std::vector<uint32_t>& indices) {
+	MeshCacheHeader header{};
+		header.magic = MESH_CACHE_MAGIC;
+		header.version = MESH_CACHE_VERSION;
+		header.vertexStride = sizeof(Vertex);
+		header.indexStride = sizeof(uint32_t);
+		header.pathHash = key.pathHash;
+		header.sourceSize = key.size;
+		header.sourceModifiedTime = key.modifiedTime;
+		header.sourceHash = sourceHash;
+		header.processingKey = processingKey;
+		header.vertexCount = vertices.size();
+		header.indexCount = indices.size();
+		header.vertexOffset = alignMeshCacheOffset(sizeof(MeshCacheHeader));
+		header.indexOffset = alignMeshCacheOffset(header.vertexOffset + vertices.size() * sizeof(Vertex));
+		header.payloadHash = hashBytes(indices.data(), indices.size() * sizeof(uint32_t), hashBytes(vertices.data(), vertices.size() * sizeof(Vertex)));
+
+	return writeFileAtomically(cachePath, [&](std::ofstream& file) {
+		const char padding[16] = {};
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(padding, static_cast<std::streamsize>(header.vertexOffset - sizeof(header)));
+		file.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(vertices.size() * sizeof(Vertex)));
+		file.write(padding, static_cast<std::streamsize>(header.indexOffset - header.vertexOffset - vertices.size() * sizeof(Vertex)));
+		file.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(indices.size() * sizeof(uint32_t)));
+	});
+}
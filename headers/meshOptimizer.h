@@ -0,0 +1,266 @@
+//Index and vertex reordering for the GPU: post-transform vertex cache (Tipsify), overdraw (cluster sort) and vertex fetch (first-use order)
+//Also contains the CPU estimators used to report the gains without a GPU
+
+struct VertexCacheStats {
+	double acmr; //Average cache miss ratio: transformed vertices per triangle, 0.5 is the best possible on a regular grid and 3 the worst
+	double atvr; //Average transformed vertex ratio: transformed vertices per referenced vertex, 1 is optimal
+};
+
+struct OverdrawStats {
+	double overdraw; //Shaded pixels per covered pixel, 1 is optimal
+	uint64_t pixelsShaded;
+	uint64_t pixelsCovered;
+};
+
+//Simulates a FIFO post-transform cache of cacheSize entries
+inline VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = 16) {
+	std::vector<uint64_t> cacheTime(vertexCount, 0);
+	std::vector<bool> referenced(vertexCount, false);
+	uint64_t time = cacheSize + 1;
+	uint64_t misses = 0, uniqueVertices = 0;
+
+	for (uint32_t index : indices) {
+		if (!referenced[index]) { referenced[index] = true; uniqueVertices++; }
+		if (time - cacheTime[index] > cacheSize) { cacheTime[index] = time++; misses++; }
+	}
+
+	VertexCacheStats stats{};
+		stats.acmr = indices.empty() ? 0.0 : static_cast<double>(misses) / static_cast<double>(indices.size() / 3);
+		stats.atvr = uniqueVertices == 0 ? 0.0 : static_cast<double>(misses) / static_cast<double>(uniqueVertices);
+	return stats;
+}
+
+//Triangles of every vertex in one flat array
+struct VertexTriangleAdjacency {
+	std::vector<uint32_t> offsets; //vertexCount + 1
+	std::vector<uint32_t> triangles;
+
+	VertexTriangleAdjacency(const std::vector<uint32_t>& indices, size_t vertexCount) : offsets(vertexCount + 1, 0), triangles(indices.size()) {
+		for (uint32_t index : indices) { offsets[index + 1]++; }
+		for (size_t i = 0; i < vertexCount; i++) { offsets[i + 1] += offsets[i]; }
+		std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++) { triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3); }
+	}
+};
+
+//Tipsify (Sander, Nehab, Barczak 2007). Fans around one vertex at a time and picks the next fanning vertex among the ones still in the cache, linear time
+inline void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = 16) {
+	VertexTriangleAdjacency adjacency(indices, vertexCount);
+	std::vector<uint32_t> liveTriangles(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++) { liveTriangles[i] = adjacency.offsets[i + 1] - adjacency.offsets[i]; }
+
+	std::vector<uint64_t> cacheTime(vertexCount, 0);
+	std::vector<bool> emitted(indices.size() / 3, false);
+	std::vector<uint32_t> deadEnds, candidates, result;
+	result.reserve(indices.size());
+	uint64_t time = cacheSize + 1;
+	size_t cursor = 0;
+
+	//Next vertex with live triangles: most recent dead end first, then input order
+	auto skipDeadEnd = [&]() -> int64_t {
+		while (!deadEnds.empty()) {
+			uint32_t vertex = deadEnds.back();
+			deadEnds.pop_back();
+			if (liveTriangles[vertex] > 0) { return vertex; }
+		}
+		for (; cursor < vertexCount; cursor++) {
+			if (liveTriangles[cursor] > 0) { return static_cast<int64_t>(cursor); }
+		}
+		return -1;
+	};
+
+	for (int64_t fanning = skipDeadEnd(); fanning >= 0;) {
+		candidates.clear();
+		for (uint32_t i = adjacency.offsets[fanning]; i < adjacency.offsets[fanning + 1]; i++) {
+			uint32_t triangle = adjacency.triangles[i];
+			if (emitted[triangle]) { continue; }
+			emitted[triangle] = true;
+			for (uint32_t corner = 0; corner < 3; corner++) {
+				uint32_t vertex = indices[triangle * 3 + corner];
+				result.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+				if (time - cacheTime[vertex] > cacheSize) { cacheTime[vertex] = time++; }
+			}
+		}
+
+		//Prefer the candidate that entered the cache earliest but will still be in it after its remaining triangles are emitted
+		int64_t next = -1;
+		uint64_t bestPriority = 0;
+		for (uint32_t vertex : candidates) {
+			if (liveTriangles[vertex] == 0) { continue; }
+			uint64_t priority = 0;
+			if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize) { priority = time - cacheTime[vertex]; }
+			if (next < 0 || priority > bestPriority) { bestPriority = priority; next = vertex; }
+		}
+		fanning = next >= 0 ? next : skipDeadEnd();
+	}
+	indices.swap(result);
+}
+
+//Reorders clusters of the cache optimized index buffer so triangles facing outwards are drawn first and occlude the rest (Sander et al. 2007, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+//Clusters are split wherever the cache restarts, and further split as long as each piece keeps its ACMR within threshold of the whole cluster, so the reordering costs at most that much cache efficiency
+inline void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, float threshold = 1.05f, uint32_t cacheSize = 16) {
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) { return; }
+
+	std::vector<uint64_t> cacheTime(vertices.size(), 0);
+	uint64_t time = cacheSize + 1;
+	auto resetCache = [&]() { time += cacheSize + 1; };
+	auto triangleMisses = [&](size_t triangle) {
+		uint32_t misses = 0;
+		for (uint32_t corner = 0; corner < 3; corner++) {
+			uint32_t vertex = indices[triangle * 3 + corner];
+			if (time - cacheTime[vertex] > cacheSize) { cacheTime[vertex] = time++; misses++; }
+		}
+		return misses;
+	};
+
+	//Hard boundaries: triangles where every vertex misses
+	std::vector<size_t> hardBoundaries;
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		if (triangleMisses(triangle) == 3) { hardBoundaries.push_back(triangle); }
+	}
+	hardBoundaries.push_back(triangleCount);
+
+	//Soft boundaries inside every hard cluster
+	std::vector<size_t> clusters;
+	for (size_t hard = 0; hard + 1 < hardBoundaries.size(); hard++) {
+		size_t begin = hardBoundaries[hard], end = hardBoundaries[hard + 1];
+		resetCache();
+		uint64_t clusterMisses = 0;
+		for (size_t triangle = begin; triangle < end; triangle++) { clusterMisses += triangleMisses(triangle); }
+		double clusterAcmr = static_cast<double>(clusterMisses) / static_cast<double>(end - begin);
+
+		resetCache();
+		clusters.push_back(begin);
+		uint64_t misses = 0;
+		for (size_t triangle = begin, start = begin; triangle < end; triangle++) {
+			misses += triangleMisses(triangle);
+			if (triangle + 1 < end && static_cast<double>(misses) / static_cast<double>(triangle + 1 - start) <= clusterAcmr * threshold) {
+				clusters.push_back(triangle + 1);
+				start = triangle + 1;
+				misses = 0;
+				resetCache();
+			}
+		}
+	}
+	clusters.push_back(triangleCount);
+
+	//Area weighted centroid and normal of every cluster, sorted by how much the cluster faces away from the mesh center
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+	std::vector<float> sortKeys(clusters.size() - 1);
+	std::vector<glm::vec3> clusterCentroids(clusters.size() - 1), clusterNormals(clusters.size() - 1);
+	for (size_t cluster = 0; cluster + 1 < clusters.size(); cluster++) {
+		glm::vec3 centroid(0.0f), normal(0.0f);
+		float area = 0.0f;
+		for (size_t triangle = clusters[cluster]; triangle < clusters[cluster + 1]; triangle++) {
+			const glm::vec3& a = vertices[indices[triangle * 3 + 0]].pos;
+			const glm::vec3& b = vertices[indices[triangle * 3 + 1]].pos;
+			const glm::vec3& c = vertices[indices[triangle * 3 + 2]].pos;
+			glm::vec3 cross = glm::cross(b - a, c - a);
+			float triangleArea = glm::length(cross);
+			centroid += (a + b + c) * (triangleArea / 3.0f);
+			normal += cross;
+			area += triangleArea;
+		}
+		meshCentroid += centroid;
+		meshArea += area;
+		clusterCentroids[cluster] = area > 0.0f ? centroid / area : centroid;
+		clusterNormals[cluster] = glm::length(normal) > 0.0f ? glm::normalize(normal) : normal;
+	}
+	if (meshArea > 0.0f) { meshCentroid /= meshArea; }
+	for (size_t cluster = 0; cluster < sortKeys.size(); cluster++) {
+		sortKeys[cluster] = glm::dot(clusterCentroids[cluster] - meshCentroid, clusterNormals[cluster]);
+	}
+
+	std::vector<size_t> order(sortKeys.size());
+	for (size_t i = 0; i < order.size(); i++) { order[i] = i; }
+	std::stable_sort(order.begin(), order.end(), [&sortKeys](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	for (size_t cluster : order) {
+		result.insert(result.end(), indices.begin() + clusters[cluster] * 3, indices.begin() + clusters[cluster + 1] * 3);
+	}
+	indices.swap(result);
+}
+
+//Renumbers vertices in the order the index buffer first uses them, so vertex fetch walks memory forwards. Unreferenced vertices are dropped
+inline void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+	std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+	std::vector<Vertex> result;
+	result.reserve(vertices.size());
+	for (uint32_t& index : indices) {
+		if (remap[index] == UINT32_MAX) {
+			remap[index] = static_cast<uint32_t>(result.size());
+			result.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+	vertices.swap(result);
+}
+
+//Rasterizes the mesh in index order from the six axis directions with back-face culling and a less-than depth test, counting how often each covered pixel gets shaded
+inline OverdrawStats analyzeOverdraw(const std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, int resolution = 256) {
+	OverdrawStats stats{};
+	if (vertices.empty()) { return stats; }
+
+	glm::vec3 minimum = vertices[0].pos, maximum = vertices[0].pos;
+	for (const Vertex& vertex : vertices) {
+		minimum = glm::min(minimum, vertex.pos);
+		maximum = glm::max(maximum, vertex.pos);
+	}
+	glm::vec3 extent = maximum - minimum;
+	float scale = static_cast<float>(resolution - 1) / std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-20f));
+
+	std::vector<float> depthBuffer(static_cast<size_t>(resolution) * resolution);
+	for (int axis = 0; axis < 3; axis++) {
+		for (float direction : {-1.0f, 1.0f}) {
+			//Viewer looks along direction * axis. Screen axes are the two other axes, depth grows away from the viewer
+			int uAxis = (axis + 1) % 3, vAxis = (axis + 2) % 3;
+			std::fill(depthBuffer.begin(), depthBuffer.end(), std::numeric_limits<float>::max());
+
+			for (size_t triangle = 0; triangle + 2 < indices.size(); triangle += 3) {
+				glm::vec3 p[3];
+				for (int corner = 0; corner < 3; corner++) {
+					glm::vec3 position = (vertices[indices[triangle + corner]].pos - minimum) * scale;
+					p[corner] = glm::vec3(position[uAxis], position[vAxis], position[axis] * direction);
+				}
+				glm::vec3 normal = glm::cross(vertices[indices[triangle + 1]].pos - vertices[indices[triangle]].pos, vertices[indices[triangle + 2]].pos - vertices[indices[triangle]].pos);
+				if (normal[axis] * direction >= 0.0f) { continue; } //Back facing
+
+				float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[1].y - p[0].y) * (p[2].x - p[0].x);
+				if (area == 0.0f) { continue; }
+				if (area < 0.0f) { std::swap(p[1], p[2]); area = -area; }
+
+				int minX = std::max(0, static_cast<int>(std::floor(std::min({p[0].x, p[1].x, p[2].x}))));
+				int maxX = std::min(resolution - 1, static_cast<int>(std::ceil(std::max({p[0].x, p[1].x, p[2].x}))));
+				int minY = std::max(0, static_cast<int>(std::floor(std::min({p[0].y, p[1].y, p[2].y}))));
+				int maxY = std::min(resolution - 1, static_cast<int>(std::ceil(std::max({p[0].y, p[1].y, p[2].y}))));
+				for (int y = minY; y <= maxY; y++) {
+					for (int x = minX; x <= maxX; x++) {
+						float px = static_cast<float>(x) + 0.5f, py = static_cast<float>(y) + 0.5f;
+						float w0 = (p[2].x - p[1].x) * (py - p[1].y) - (p[2].y - p[1].y) * (px - p[1].x);
+						float w1 = (p[0].x - p[2].x) * (py - p[2].y) - (p[0].y - p[2].y) * (px - p[2].x);
+						float w2 = (p[1].x - p[0].x) * (py - p[0].y) - (p[1].y - p[0].y) * (px - p[0].x);
+						if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) { continue; }
+
+						float depth = (w0 * p[0].z + w1 * p[1].z + w2 * p[2].z) / area;
+						float& stored = depthBuffer[static_cast<size_t>(y) * resolution + x];
+						if (depth < stored) {
+							if (stored == std::numeric_limits<float>::max()) { stats.pixelsCovered++; }
+							stored = depth;
+							stats.pixelsShaded++;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	stats.overdraw = stats.pixelsCovered == 0 ? 0.0 : static_cast<double>(stats.pixelsShaded) / static_cast<double>(stats.pixelsCovered);
+	return stats;
+}
@@ -0,0 +1,184 @@
+//Meshlets: small clusters of triangles with a bounding sphere and a normal cone, culled on the CPU and drawn one vkCmdDrawIndexed each
+//Meshlets are contiguous runs of the final index buffer and never cross an IndexRange, so they draw straight from the regular index buffer
+
+const uint32_t MESHLET_MAX_VERTICES = 64;
+const uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+struct Meshlet {
+	uint32_t firstIndex;
+	uint32_t triangleCount;
+	int32_t vertexOffset; //Of the IndexRange the meshlet lies in
+	uint32_t vertexCount;
+};
+
+struct MeshletBounds {
+	glm::vec3 center;
+	float radius;
+	glm::vec3 coneAxis;
+	float coneCutoff; //sin of the cone half angle, 1 when the cone is too wide to ever cull
+};
+
+struct MeshletCullStats {
+	uint64_t tested;
+	uint64_t frustumCulled;
+	uint64_t coneCulled;
+};
+
+//Greedy scan in draw order. A meshlet is closed when the next triangle would exceed the vertex or triangle limit, or at the end of an index range
+inline std::vector<Meshlet> buildMeshlets(const std::vector<uint32_t>& indices, size_t vertexCount, const std::vector<IndexRange>& ranges,
+	uint32_t maxVertices = MESHLET_MAX_VERTICES, uint32_t maxTriangles = MESHLET_MAX_TRIANGLES) {
+	std::vector<Meshlet> meshlets;
+	std::vector<uint32_t> lastMeshlet(vertexCount, UINT32_MAX); //Id of the meshlet that last referenced the vertex, saves clearing per meshlet
+
+	for (const IndexRange& range : ranges) {
+		Meshlet meshlet{range.firstIndex, 0, range.vertexOffset, 0};
+		for (uint32_t triangle = range.firstIndex; triangle + 2 < range.firstIndex + range.indexCount; triangle += 3) {
+			uint32_t id = static_cast<uint32_t>(meshlets.size());
+			uint32_t newVertices = 0;
+			for (uint32_t corner = 0; corner < 3; corner++) {
+				uint32_t vertex = indices[triangle + corner];
+				bool repeated = (corner > 0 && vertex == indices[triangle]) || (corner > 1 && vertex == indices[triangle + 1]);
+				if (lastMeshlet[vertex] != id && !repeated) { newVertices++; }
+			}
+
+			if (meshlet.triangleCount > 0 && (meshlet.vertexCount + newVertices > maxVertices || meshlet.triangleCount + 1 > maxTriangles)) {
+				meshlets.push_back(meshlet);
+				meshlet = Meshlet{triangle, 0, range.vertexOffset, 0};
+				id++;
+				newVertices = 0;
+				for (uint32_t corner = 0; corner < 3; corner++) {
+					uint32_t vertex = indices[triangle + corner];
+					bool repeated = (corner > 0 && vertex == indices[triangle]) || (corner > 1 && vertex == indices[triangle + 1]);
+					newVertices += !repeated;
+				}
+			}
+			for (uint32_t corner = 0; corner < 3; corner++) { lastMeshlet[indices[triangle + corner]] = id; }
+			meshlet.vertexCount += newVertices;
+			meshlet.triangleCount++;
+		}
+		if (meshlet.triangleCount > 0) { meshlets.push_back(meshlet); }
+	}
+	return meshlets;
+}
+
+inline MeshletBounds computeMeshletBounds(const Meshlet& meshlet, const std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices) {
+	const uint32_t indexCount = meshlet.triangleCount * 3;
+
+	//Sphere around the AABB center
+	glm::vec3 minimum = vertices[indices[meshlet.firstIndex]].pos, maximum = minimum;
+	for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + indexCount; i++) {
+		minimum = glm::min(minimum, vertices[indices[i]].pos);
+		maximum = glm::max(maximum, vertices[indices[i]].pos);
+	}
+	MeshletBounds bounds{};
+		bounds.center = (minimum + maximum) * 0.5f;
+	for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + indexCount; i++) {
+		bounds.radius = std::max(bounds.radius, glm::length(vertices[indices[i]].pos - bounds.center));
+	}
+
+	//Normal cone: average normal as the axis, the widest triangle normal decides the angle
+	std::vector<glm::vec3> normals;
+	normals.reserve(meshlet.triangleCount);
+	glm::vec3 axis(0.0f);
+	for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + indexCount; i += 3) {
+		const glm::vec3& a = vertices[indices[i]].pos;
+		glm::vec3 normal = glm::cross(vertices[indices[i + 1]].pos - a, vertices[indices[i + 2]].pos - a);
+		float length = glm::length(normal);
+		if (length == 0.0f) { continue; }
+		normals.push_back(normal / length);
+		axis += normal / length;
+	}
+
+	bounds.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+	bounds.coneCutoff = 1.0f;
+	if (normals.empty() || glm::length(axis) == 0.0f) { return bounds; }
+	axis = glm::normalize(axis);
+	float minimumDot = 1.0f;
+	for (const glm::vec3& normal : normals) { minimumDot = std::min(minimumDot, glm::dot(normal, axis)); }
+	if (minimumDot > 0.0f) {
+		bounds.coneAxis = axis;
+		bounds.coneCutoff = std::sqrt(1.0f - minimumDot * minimumDot);
+	}
+	return bounds;
+}
+
+//Frustum planes (xyz normal, w distance) in the space the matrix transforms from, for Vulkan's 0..1 clip depth
+inline std::array<glm::vec4, 6> extractFrustumPlanes(const glm::mat4& matrix) {
+	auto row = [&matrix](int i) { return glm::vec4(matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]); };
+	std::array<glm::vec4, 6> planes = {row(3) + row(0), row(3) - row(0), row(3) + row(1), row(3) - row(1), row(2), row(3) - row(2)};
+	for (glm::vec4& plane : planes) { plane /= glm::length(glm::vec3(plane)); }
+	return planes;
+}
+
+//Both tests run in model space, valid as long as the model matrix does not scale
+inline bool isMeshletVisible(const MeshletBounds& bounds, const std::array<glm::vec4, 6>& planes, const glm::vec3& cameraPosition, MeshletCullStats& stats) {
+	stats.tested++;
+	for (const glm::vec4& plane : planes) {
+		if (glm::dot(glm::vec3(plane), bounds.center) + plane.w < -bounds.radius) { stats.frustumCulled++; return false; }
+	}
+	glm::vec3 toCenter = bounds.center - cameraPosition;
+	if (glm::dot(toCenter, bounds.coneAxis) >= bounds.coneCutoff * glm::length(toCenter) + bounds.radius) { stats.coneCulled++; return false; }
+	return true;
+}
+
+//Binary meshlet cache next to the model: MeshletCacheHeader | Meshlet[meshletCount] | MeshletBounds[meshletCount]
+//Keyed by a hash of the vertices, indices and index ranges it was built from, so any change to an earlier mesh stage rebuilds it
+const uint32_t MESHLET_CACHE_MAGIC = 0x4C4D4B56; //"VKML"
+const uint32_t MESHLET_CACHE_VERSION = 1;
+
+struct MeshletCacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t maxVertices;
+	uint32_t maxTriangles;
+	uint64_t meshHash;
+	uint64_t meshletCount;
+	uint64_t payloadHash;
+};
+
+inline uint64_t hashMeshletSource(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<IndexRange>& ranges) {
+	uint64_t hash = hashBytes(vertices.data(), vertices.size() * sizeof(Vertex));
+	hash = hashBytes(indices.data(), indices.size() * sizeof(uint32_t), hash);
+	return hashBytes(ranges.data(), ranges.size() * sizeof(IndexRange), hash);
+}
+
+//Returns false if the cache is missing, stale or corrupt
+inline bool readMeshletCache(const std::string& cachePath, uint64_t meshHash, std::vector<Meshlet>& meshlets, std::vector<MeshletBounds>& bounds) {
+	std::ifstream file(cachePath, std::ios::binary | std::ios::ate);
+	if (!file.is_open()) { return false; }
+	size_t fileSize = static_cast<size_t>(file.tellg());
+	file.seekg(0);
+
+	MeshletCacheHeader header{};
+	if (fileSize < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) { return false; }
+	if (header.magic != MESHLET_CACHE_MAGIC || header.version != MESHLET_CACHE_VERSION || header.meshHash != meshHash ||
+		header.maxVertices != MESHLET_MAX_VERTICES || header.maxTriangles != MESHLET_MAX_TRIANGLES) { return false; }
+	if (fileSize != sizeof(header) + header.meshletCount * (sizeof(Meshlet) + sizeof(MeshletBounds))) { return false; }
+
+	meshlets.resize(static_cast<size_t>(header.meshletCount));
+	bounds.resize(static_cast<size_t>(header.meshletCount));
+	file.read(reinterpret_cast<char*>(meshlets.data()), static_cast<std::streamsize>(meshlets.size() * sizeof(Meshlet)));
+	file.read(reinterpret_cast<char*>(bounds.data()), static_cast<std::streamsize>(bounds.size() * sizeof(MeshletBounds)));
+	if (!file) { return false; }
+
+	uint64_t payloadHash = hashBytes(bounds.data(), bounds.size() * sizeof(MeshletBounds), hashBytes(meshlets.data(), meshlets.size() * sizeof(Meshlet)));
+	return payloadHash == header.payloadHash;
+}
+
+//Returns false if the cache could not be written
+inline bool writeMeshletCache(const std::string& cachePath, uint64_t meshHash, const std::vector<Meshlet>& meshlets, const std::vector<MeshletBounds>& bounds) {
+	MeshletCacheHeader header{};
+		header.magic = MESHLET_CACHE_MAGIC;
+		header.version = MESHLET_CACHE_VERSION;
+		header.maxVertices = MESHLET_MAX_VERTICES;
+		header.maxTriangles = MESHLET_MAX_TRIANGLES;
+		header.meshHash = meshHash;
+		header.meshletCount = meshlets.size();
+		header.payloadHash = hashBytes(bounds.data(), bounds.size() * sizeof(MeshletBounds), hashBytes(meshlets.data(), meshlets.size() * sizeof(Meshlet)));
+
+	return writeFileAtomically(cachePath, [&](std::ofstream& file) {
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(meshlets.data()), static_cast<std::streamsize>(meshlets.size() * sizeof(Meshlet)));
+		file.write(reinterpret_cast<const char*>(bounds.data()), static_cast<std::streamsize>(bounds.size() * sizeof(MeshletBounds)));
+	});
+}
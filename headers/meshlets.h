@@ -0,0 +1,43 @@
+//Cluster render path (RENDER_PATH == RenderPath::Meshlets). Runs after createIndexRanges() because meshlets follow the index ranges
+//Meshlets only cover the full mesh (lods[0]), coarser levels are drawn as plain index ranges
+void createMeshlets() {
+	if (RENDER_PATH != RenderPath::Meshlets) { return; }
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	std::string cachePath = MODEL_PATH + ".meshlets";
+	std::vector<IndexRange> fullMeshRanges = clipIndexRanges(indexRanges, lods[0].firstIndex, lods[0].indexCount);
+	uint64_t meshHash = hashMeshletSource(vertices, indices, fullMeshRanges);
+	bool cacheHit = readMeshletCache(cachePath, meshHash, meshlets, meshletBounds);
+	if (!cacheHit) {
+		meshlets = buildMeshlets(indices, vertices.size(), fullMeshRanges);
+		meshletBounds.resize(meshlets.size());
+		for (size_t i = 0; i < meshlets.size(); i++) { meshletBounds[i] = computeMeshletBounds(meshlets[i], indices, vertices); }
+		if (!writeMeshletCache(cachePath, meshHash, meshlets, meshletBounds)) { std::cerr << "failed to write meshlet cache " << cachePath << std::endl; }
+	}
+	auto endTime = std::chrono::high_resolution_clock::now();
+
+	uint64_t vertexSum = 0;
+	for (const Meshlet& meshlet : meshlets) { vertexSum += meshlet.vertexCount; }
+	std::cout << (cacheHit ? "Loaded " : "Built ") << meshlets.size() << " meshlets in " << std::chrono::duration<double, std::milli>(endTime - startTime).count()
+		<< " ms, " << (meshlets.empty() ? 0.0 : static_cast<double>(vertexSum) / meshlets.size()) << " vertices and "
+		<< (meshlets.empty() ? 0.0 : lods[0].indexCount / 3.0 / meshlets.size()) << " triangles per meshlet on average" << std::endl;
+}
+
+//Frustum and normal cone culling against the matrices of the frame being recorded
+void cullMeshlets(const UniformBufferObject& ubo) {
+	glm::mat4 modelView = ubo.view * ubo.model;
+	std::array<glm::vec4, 6> planes = extractFrustumPlanes(ubo.proj * modelView);
+	glm::vec3 cameraPosition = glm::vec3(glm::inverse(modelView) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+
+	visibleMeshlets.clear();
+	for (uint32_t i = 0; i < meshlets.size(); i++) {
+		if (isMeshletVisible(meshletBounds[i], planes, cameraPosition, meshletCullStats)) { visibleMeshlets.push_back(i); }
+	}
+}
+
+void reportMeshletCulling() {
+	if (RENDER_PATH != RenderPath::Meshlets || meshletCullStats.tested == 0) { return; }
+	double tested = static_cast<double>(meshletCullStats.tested);
+	std::cout << "Meshlet culling: " << meshletCullStats.frustumCulled / tested * 100.0 << "% frustum culled, " << meshletCullStats.coneCulled / tested * 100.0
+		<< "% cone culled, " << (tested - meshletCullStats.frustumCulled - meshletCullStats.coneCulled) / tested * 100.0 << "% drawn" << std::endl;
+}
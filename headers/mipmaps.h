@@ -5,12 +5,14 @@ void generateMipmaps(
 	int32_t texHeight,
 	uint32_t mipLevels
 	) {
+	TraceScope traceScope("generateMipmaps", "assets");
 	//Check if image format supports linear blitting
 	VkFormatProperties formatProperties;
 	vkGetPhysicalDeviceFormatProperties(physicalDevice, imageFormat, &formatProperties);
 	if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) { throw std::runtime_error("texture image format does not support linear blitting!"); }
 
-	VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+	VkCommandBuffer commandBuffer = graphicsUploadCommands();
+	GpuScope mipmapScope(gpuProfiler.get(), commandBuffer, "mipmaps");
 
 	VkImageMemoryBarrier barrier{};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -93,5 +95,6 @@ void generateMipmaps(
 		0, nullptr,
 		1, &barrier);
 
-	endSingleTimeCommands(commandBuffer);
+	mipmapScope.end(); //finishUploadCommands() may submit the command buffer
+	finishUploadCommands();
 }
\ No newline at end of file
@@ -0,0 +1,201 @@
+//Minimal OBJ text parser used by the parallel and memory-mapped model loaders. Only positions, texture coordinates and faces are read, everything else (normals, materials, groups) is skipped like loadModel() already ignores it
+
+struct ObjCorner {
+	int32_t position; //After resolving: 0-based, or chunk-local when listed in ObjChunk::relativePositions
+	int32_t texcoord; //Same as position, only meaningful with hasTexcoord
+	bool hasTexcoord;
+};
+
+struct ObjChunk {
+	const char* begin = nullptr;
+	const char* end = nullptr;
+
+	std::vector<float> positions; //xyz
+	std::vector<float> texcoords; //uv
+	std::vector<ObjCorner> corners; //Triangulated, 3 per triangle
+
+	//Negative (relative) OBJ indices refer to elements counted so far, which depend on the chunks before this one. They are stored chunk-local and fixed up once the chunk offsets are known
+	std::vector<uint32_t> relativePositions;
+	std::vector<uint32_t> relativeTexcoords;
+};
+
+inline bool isObjSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+inline void skipObjSpaces(const char*& p, const char* end) {
+	while (p < end && isObjSpace(*p)) { p++; }
+}
+
+//Fast decimal parser. Exact powers of ten up to 1e22 keep the result correctly rounded for the 6-8 significant digits OBJ exporters write
+inline float parseObjFloat(const char*& p, const char* end) {
+	static const double powersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+	skipObjSpaces(p, end);
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) { negative = *p == '-'; p++; }
+
+	uint64_t mantissa = 0;
+	int exponent = 0;
+	int digits = 0;
+	for (; p < end && *p >= '0' && *p <= '9'; p++) {
+		if (digits < 19) { mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0'); digits += mantissa != 0; }
+		else { exponent++; }
+	}
+	if (p < end && *p == '.') {
+		for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+			if (digits < 19) { mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0'); digits += mantissa != 0; exponent--; }
+		}
+	}
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		p++;
+		bool negativeExponent = false;
+		if (p < end && (*p == '-' || *p == '+')) { negativeExponent = *p == '-'; p++; }
+		int value = 0;
+		for (; p < end && *p >= '0' && *p <= '9'; p++) { if (value < 10000) { value = value * 10 + (*p - '0'); } }
+		exponent += negativeExponent ? -value : value;
+	}
+
+	double result = static_cast<double>(mantissa);
+	if (exponent < 0) { result = exponent >= -22 ? result / powersOfTen[-exponent] : result * std::pow(10.0, exponent); }
+	else if (exponent > 0) { result = exponent <= 22 ? result * powersOfTen[exponent] : result * std::pow(10.0, exponent); }
+	return static_cast<float>(negative ? -result : result);
+}
+
+inline bool parseObjIndex(const char*& p, const char* end, int32_t& index) {
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) { negative = *p == '-'; p++; }
+	if (p >= end || *p < '0' || *p > '9') { return false; }
+	int64_t value = 0;
+	for (; p < end && *p >= '0' && *p <= '9'; p++) { value = value * 10 + (*p - '0'); }
+	index = static_cast<int32_t>(negative ? -value : value);
+	return true;
+}
+
+//Turn a 1-based or negative OBJ index into a 0-based one, negative indices count back from the elements seen so far
+inline int32_t resolveObjIndex(int32_t index, size_t count, bool& relative) {
+	if (index > 0) { return index - 1; }
+	relative = true;
+	return static_cast<int32_t>(static_cast<int64_t>(count) + index);
+}
+
+//Reads the "v/vt/vn" corners of a face line. Indices are returned as written in the file, texcoord is 0 and hasTexcoord false when missing
+inline void parseObjFace(const char*& p, const char* end, std::vector<ObjCorner>& polygon) {
+	polygon.clear();
+
+	while (true) {
+		skipObjSpaces(p, end);
+		int32_t positionIndex, texcoordIndex = 0;
+		if (!parseObjIndex(p, end, positionIndex)) { break; }
+		if (p < end && *p == '/') {
+			p++;
+			if (p < end && *p != '/') { parseObjIndex(p, end, texcoordIndex); }
+			if (p < end && *p == '/') { //Normal index is not used
+				p++;
+				int32_t normalIndex;
+				parseObjIndex(p, end, normalIndex);
+			}
+		}
+		polygon.push_back({positionIndex, texcoordIndex, texcoordIndex != 0});
+	}
+}
+
+//Walks OBJ text and hands positions, texture coordinates and fan-triangulated face corners to the sink:
+//	sink.position(x, y, z), sink.texcoord(u, v), sink.corner(ObjCorner) with the raw file indices
+template<typename Sink>
+inline void parseObjLines(const char* p, const char* end, Sink& sink) {
+	std::vector<ObjCorner> polygon;
+
+	while (p < end) {
+		skipObjSpaces(p, end);
+		if (p + 1 < end && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+			p++;
+			float x = parseObjFloat(p, end);
+			float y = parseObjFloat(p, end);
+			float z = parseObjFloat(p, end);
+			sink.position(x, y, z);
+		} else if (p + 2 < end && p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t')) {
+			p += 2;
+			float u = parseObjFloat(p, end);
+			float v = parseObjFloat(p, end);
+			sink.texcoord(u, v);
+		} else if (p + 1 < end && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+			p++;
+			parseObjFace(p, end, polygon);
+			//Fan triangulation, same winding as the source polygon
+			for (size_t i = 2; i < polygon.size(); i++) {
+				sink.corner(polygon[0]);
+				sink.corner(polygon[i - 1]);
+				sink.corner(polygon[i]);
+			}
+		}
+		//Skip the rest of the line (comments, normals, groups, materials and any trailing values)
+		while (p < end && *p != '\n') { p++; }
+		if (p < end) { p++; }
+	}
+}
+
+//Collects one chunk into local arrays for the parallel loader
+struct ObjChunkSink {
+	ObjChunk& chunk;
+
+	void position(float x, float y, float z) { chunk.positions.insert(chunk.positions.end(), {x, y, z}); }
+	void texcoord(float u, float v) { chunk.texcoords.insert(chunk.texcoords.end(), {u, v}); }
+	void corner(ObjCorner corner) {
+		bool relativePosition = false, relativeTexcoord = false;
+		corner.position = resolveObjIndex(corner.position, chunk.positions.size() / 3, relativePosition);
+		if (corner.hasTexcoord) { corner.texcoord = resolveObjIndex(corner.texcoord, chunk.texcoords.size() / 2, relativeTexcoord); }
+		if (relativePosition) { chunk.relativePositions.push_back(static_cast<uint32_t>(chunk.corners.size())); }
+		if (relativeTexcoord) { chunk.relativeTexcoords.push_back(static_cast<uint32_t>(chunk.corners.size())); }
+		chunk.corners.push_back(corner);
+	}
+};
+
+inline void parseObjChunk(ObjChunk& chunk) {
+	ObjChunkSink sink{chunk};
+	parseObjLines(chunk.begin, chunk.end, sink);
+}
+
+//Relative indices that reach back before the first element resolve below 0 and are rejected like ones past the end
+inline void checkObjCorner(const std::vector<float>& positions, const std::vector<float>& texcoords, const ObjCorner& corner) {
+	if (corner.position < 0 || static_cast<size_t>(corner.position) >= positions.size() / 3) { throw std::runtime_error("OBJ face index out of range!"); }
+	if (corner.hasTexcoord && (corner.texcoord < 0 || static_cast<size_t>(corner.texcoord) >= texcoords.size() / 2)) { throw std::runtime_error("OBJ face index out of range!"); }
+}
+
+//Build the renderer vertex for a resolved corner, flipping V like the tinyobj path
+inline Vertex makeObjVertex(const std::vector<float>& positions, const std::vector<float>& texcoords, const ObjCorner& corner) {
+	checkObjCorner(positions, texcoords, corner);
+
+	Vertex vertex{};
+	vertex.pos = {
+		positions[3 * corner.position + 0],
+		positions[3 * corner.position + 1],
+		positions[3 * corner.position + 2]
+	};
+	if (corner.hasTexcoord) {
+		vertex.texCoord = {
+			texcoords[2 * corner.texcoord + 0],
+			1.0f - texcoords[2 * corner.texcoord + 1]
+		};
+	}
+	vertex.color = {1.0f, 1.0f, 1.0f};
+	return vertex;
+}
+
+//Split the file into roughly equal chunks that always end on a line break
+inline std::vector<ObjChunk> splitObjChunks(const char* data, size_t size, size_t chunkCount) {
+	std::vector<ObjChunk> chunks;
+	const char* end = data + size;
+	const char* begin = data;
+	for (size_t i = 1; i <= chunkCount && begin < end; i++) {
+		const char* chunkEnd = i == chunkCount ? end : data + size * i / chunkCount;
+		if (chunkEnd < begin) { chunkEnd = begin; }
+		while (chunkEnd < end && *chunkEnd != '\n') { chunkEnd++; }
+		if (chunkEnd < end) { chunkEnd++; }
+
+		ObjChunk chunk;
+			chunk.begin = begin;
+			chunk.end = chunkEnd;
+		chunks.push_back(std::move(chunk));
+		begin = chunkEnd;
+	}
+	return chunks;
+}
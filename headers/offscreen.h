@@ -0,0 +1,27 @@
+//Headless mode (HEADLESS). Offscreen color images take the place of the swapchain images, one per frame slot, so the render pass, framebuffers and
+//command buffers are the same as with a window. drawFrame() renders into the image of currentFrame and skips acquire and present
+void createOffscreenTargets() {
+	swapChainImageFormat = findSupportedFormat({VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_R8G8B8A8_SRGB}, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT);
+	swapChainExtent = {WIDTH, HEIGHT};
+
+	swapChainImages.resize(MAX_FRAMES_IN_FLIGHT);
+	offscreenImagesMemory.resize(MAX_FRAMES_IN_FLIGHT);
+	for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+		createImage(WIDTH, HEIGHT, 1, swapChainImageFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, swapChainImages[i], offscreenImagesMemory[i]);
+	}
+}
+
+//Throughput run on the loaded scene, nothing waits on a display so this measures the renderer alone (e.g. on lavapipe in CI)
+void runHeadless() {
+	waitForAssets();
+	for (uint32_t frame = 0; frame < HEADLESS_FRAMES / 10; frame++) { drawFrame(); } //Warmup
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+	for (uint32_t frame = 0; frame < HEADLESS_FRAMES; frame++) { drawFrame(); }
+	vkDeviceWaitIdle(device);
+	double totalTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+	std::cout << "Headless: " << HEADLESS_FRAMES << " frames at " << WIDTH << "x" << HEIGHT << " in " << std::fixed << std::setprecision(3) << totalTime << " ms, "
+		<< totalTime / HEADLESS_FRAMES << " ms per frame, " << HEADLESS_FRAMES * 1000.0 / totalTime << " fps" << std::defaultfloat << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+//Called by loadModel() when the mesh is not cached, the mesh cache stores the result: vertex cache order, then overdraw order, then vertex fetch order
+void optimizeMesh() {
+	if (!OPTIMIZE_MESH) { return; }
+
+	VertexCacheStats cacheBefore = analyzeVertexCache(indices, vertices.size());
+	OverdrawStats overdrawBefore = analyzeOverdraw(indices, vertices);
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+	optimizeVertexCache(indices, vertices.size());
+	optimizeOverdraw(indices, vertices, OVERDRAW_THRESHOLD);
+	optimizeVertexFetch(vertices, indices);
+	auto endTime = std::chrono::high_resolution_clock::now();
+
+	VertexCacheStats cacheAfter = analyzeVertexCache(indices, vertices.size());
+	OverdrawStats overdrawAfter = analyzeOverdraw(indices, vertices);
+
+	std::cout << "Mesh optimization: " << std::chrono::duration<double, std::milli>(endTime - startTime).count() << " ms | ACMR "
+		<< cacheBefore.acmr << " -> " << cacheAfter.acmr << ", ATVR " << cacheBefore.atvr << " -> " << cacheAfter.atvr
+		<< ", overdraw " << overdrawBefore.overdraw << " -> " << overdrawAfter.overdraw << std::endl;
+}
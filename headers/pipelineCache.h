@@ -0,0 +1,55 @@
+//Persistent pipeline cache (USE_PIPELINE_CACHE). Loaded from PIPELINE_CACHE_PATH before the first pipeline is created if it was written by the same
+//device and driver, saved on shutdown and every PIPELINE_CACHE_SAVE_INTERVAL seconds while it changes
+void createPipelineCache() {
+	if (!USE_PIPELINE_CACHE) { return; }
+
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	std::vector<char> data;
+	PipelineCacheStatus status = readPipelineCache(PIPELINE_CACHE_PATH, properties, data);
+	pipelineCacheWarm = status == PipelineCacheStatus::Hit;
+	if (!pipelineCacheWarm) { data.clear(); }
+
+	VkPipelineCacheCreateInfo cacheInfo{};
+		cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		cacheInfo.initialDataSize = data.size();
+		cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+	if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS) { throw std::runtime_error("failed to create pipeline cache!"); }
+
+	const char* statusNames[] = {"loaded", "missing", "stale", "corrupt"};
+	std::cout << "Pipeline cache " << PIPELINE_CACHE_PATH << " " << statusNames[static_cast<int>(status)] << (pipelineCacheWarm ? ", " + std::to_string(data.size() / 1024) + " KB" : ", starting cold") << std::endl;
+	savedPipelineCacheHash = hashBytes(data.data(), data.size());
+	lastPipelineCacheSave = std::chrono::high_resolution_clock::now();
+}
+
+//Only writes when the cache data changed since the last save. Compared by hash, the driver may replace entries without changing the size
+void savePipelineCache() {
+	if (pipelineCache == VK_NULL_HANDLE) { return; }
+	lastPipelineCacheSave = std::chrono::high_resolution_clock::now();
+
+	size_t size = 0;
+	if (vkGetPipelineCacheData(device, pipelineCache, &size, nullptr) != VK_SUCCESS) { return; }
+	std::vector<char> data(size);
+	if (vkGetPipelineCacheData(device, pipelineCache, &size, data.data()) != VK_SUCCESS) { return; }
+	data.resize(size);
+	uint64_t dataHash = hashBytes(data.data(), data.size());
+	if (dataHash == savedPipelineCacheHash) { return; }
+
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	if (writePipelineCache(PIPELINE_CACHE_PATH, properties, data)) { savedPipelineCacheHash = dataHash; }
+	else { std::cerr << "failed to write pipeline cache " << PIPELINE_CACHE_PATH << std::endl; }
+}
+
+//Called once per frame
+void updatePipelineCache() {
+	if (pipelineCache == VK_NULL_HANDLE) { return; }
+	double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - lastPipelineCacheSave).count();
+	if (seconds >= PIPELINE_CACHE_SAVE_INTERVAL) { savePipelineCache(); }
+}
+
+void destroyPipelineCache() {
+	savePipelineCache();
+	vkDestroyPipelineCache(device, pipelineCache, nullptr);
+	pipelineCache = VK_NULL_HANDLE;
+}
\ No newline at end of file
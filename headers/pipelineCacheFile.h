@@ -0,0 +1,68 @@
+//On-disk VkPipelineCache data. Layout: PipelineCacheFileHeader | cache data as returned by vkGetPipelineCacheData
+//The driver validates its own header too, but a stale or damaged blob is cheaper to reject here than to hand to a driver that may not
+
+const uint32_t PIPELINE_CACHE_MAGIC = 0x43505656; //"VVPC"
+const uint32_t PIPELINE_CACHE_VERSION = 1;
+
+struct PipelineCacheFileHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t vendorID;
+	uint32_t deviceID;
+	uint32_t driverVersion;
+	uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+	uint64_t dataSize;
+	uint64_t dataHash; //Detects truncated or corrupted files
+};
+
+enum class PipelineCacheStatus { Hit, Missing, Stale, Corrupt };
+
+inline bool pipelineCacheMatchesDevice(const PipelineCacheFileHeader& header, const VkPhysicalDeviceProperties& properties) {
+	return header.vendorID == properties.vendorID && header.deviceID == properties.deviceID && header.driverVersion == properties.driverVersion &&
+		memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+//Reads and validates the file, on a hit data holds the cache data to pass to vkCreatePipelineCache
+inline PipelineCacheStatus readPipelineCache(const std::string& path, const VkPhysicalDeviceProperties& properties, std::vector<char>& data) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file.is_open()) { return PipelineCacheStatus::Missing; }
+	uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+	if (fileSize < sizeof(PipelineCacheFileHeader)) { return PipelineCacheStatus::Corrupt; }
+
+	PipelineCacheFileHeader header;
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file || header.magic != PIPELINE_CACHE_MAGIC) { return PipelineCacheStatus::Corrupt; }
+	if (header.version != PIPELINE_CACHE_VERSION || !pipelineCacheMatchesDevice(header, properties)) { return PipelineCacheStatus::Stale; }
+	if (header.dataSize != fileSize - sizeof(header)) { return PipelineCacheStatus::Corrupt; }
+
+	data.resize(static_cast<size_t>(header.dataSize));
+	file.read(data.data(), static_cast<std::streamsize>(data.size()));
+	if (!file || hashBytes(data.data(), data.size()) != header.dataHash) { return PipelineCacheStatus::Corrupt; }
+
+	//The driver's own header at the start of the data has to agree as well
+	VkPipelineCacheHeaderVersionOne driverHeader;
+	if (data.size() < sizeof(driverHeader)) { return PipelineCacheStatus::Corrupt; }
+	memcpy(&driverHeader, data.data(), sizeof(driverHeader));
+	if (driverHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE || driverHeader.vendorID != properties.vendorID || driverHeader.deviceID != properties.deviceID ||
+		memcmp(driverHeader.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) { return PipelineCacheStatus::Stale; }
+	return PipelineCacheStatus::Hit;
+}
+
+//Returns false if the cache could not be written
+inline bool writePipelineCache(const std::string& path, const VkPhysicalDeviceProperties& properties, const std::vector<char>& data) {
+	PipelineCacheFileHeader header{};
+		header.magic = PIPELINE_CACHE_MAGIC;
+		header.version = PIPELINE_CACHE_VERSION;
+		header.vendorID = properties.vendorID;
+		header.deviceID = properties.deviceID;
+		header.driverVersion = properties.driverVersion;
+		memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+		header.dataSize = data.size();
+		header.dataHash = hashBytes(data.data(), data.size());
+
+	return writeFileAtomically(path, [&](std::ofstream& file) {
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(data.data(), static_cast<std::streamsize>(data.size()));
+	});
+}
@@ -0,0 +1,27 @@
+//State tuple of a graphics pipeline permutation. The render pass, pipeline layout and dynamic viewport/scissor are shared by every permutation
+struct PipelineKey {
+	std::string vertexShader; //SPIR-V paths
+	std::string fragmentShader;
+	VertexFormat vertexFormat; //Vertex layout, together with instanced
+	bool instanced;
+	VkCullModeFlags cullMode;
+	bool alphaBlend; //Source alpha over, opaque otherwise
+	bool depthTest;
+	bool depthWrite;
+	VkSampleCountFlagBits samples; //Has to match the render pass
+
+	bool operator==(const PipelineKey& other) const {
+		return std::tie(vertexShader, fragmentShader, vertexFormat, instanced, cullMode, alphaBlend, depthTest, depthWrite, samples) ==
+			std::tie(other.vertexShader, other.fragmentShader, other.vertexFormat, other.instanced, other.cullMode, other.alphaBlend, other.depthTest, other.depthWrite, other.samples);
+	}
+};
+
+struct PipelineKeyHash {
+	size_t operator()(const PipelineKey& key) const {
+		uint64_t hash = hashString(key.vertexShader);
+		hash = hashBytes(key.fragmentShader.data(), key.fragmentShader.size(), hash);
+		uint32_t state[] = {static_cast<uint32_t>(key.vertexFormat), key.instanced, static_cast<uint32_t>(key.cullMode), key.alphaBlend, key.depthTest, key.depthWrite, static_cast<uint32_t>(key.samples)};
+		return static_cast<size_t>(hashBytes(state, sizeof(state), hash));
+	}
+};
+
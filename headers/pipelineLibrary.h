@@ -0,0 +1,76 @@
+//Pipeline permutations keyed by PipelineKey. Identical requests share one entry, missing permutations are built on worker threads and published by
+//update() on the thread that owns the library, until then request() returns the fallback so recording never waits on a compile. build runs on the
+//workers, everything else only on the owning thread. A permutation whose build fails is reported once and keeps the fallback, it is never retried
+class PipelineLibrary {
+public:
+	using Build = std::function<VkPipeline(const PipelineKey& key)>;
+	using Destroy = std::function<void(VkPipeline pipeline)>;
+
+	//The library owns fallback from here on
+	PipelineLibrary(unsigned int threadCount, Build buildPipeline, Destroy destroyPipeline, const PipelineKey& fallbackKey, VkPipeline fallback)
+		: build(std::move(buildPipeline)), destroy(std::move(destroyPipeline)), fallback(fallback), compiler(threadCount) {
+		entries[fallbackKey].pipeline = fallback;
+	}
+
+	//Queued and running builds are finished first, their pipelines are destroyed with the rest. Only once the device is idle
+	~PipelineLibrary() {
+		while (!compiler.idle()) {
+			compiler.waitForCompletion();
+			compiler.runCompletions();
+		}
+		compiler.runCompletions();
+		for (const auto& entry : entries) {
+			if (entry.second.pipeline != VK_NULL_HANDLE) { destroy(entry.second.pipeline); }
+		}
+	}
+
+	PipelineLibrary(const PipelineLibrary&) = delete;
+	PipelineLibrary& operator=(const PipelineLibrary&) = delete;
+
+	//The permutation for key if it is ready, the fallback otherwise. A new key is queued for a build
+	VkPipeline request(const PipelineKey& key) {
+		auto found = entries.find(key);
+		if (found != entries.end()) { return found->second.pipeline != VK_NULL_HANDLE ? found->second.pipeline : fallback; }
+
+		entries[key]; //Null until the build completes, so repeated requests do not queue it again
+		compilingCount++;
+		compiler.submit([this, key]() {
+			auto startTime = std::chrono::high_resolution_clock::now();
+			VkPipeline pipeline = VK_NULL_HANDLE;
+			std::string error;
+			try { pipeline = build(key); }
+			catch (const std::exception& exception) { error = exception.what(); } //A broken permutation keeps drawing with the fallback instead of ending the app
+			double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+			return AssetLoader::Completion([this, key, pipeline, error, milliseconds]() {
+				entries[key].pipeline = pipeline;
+				compilingCount--;
+				if (pipeline == VK_NULL_HANDLE) {
+					failedCount++;
+					std::cerr << "failed to compile pipeline permutation " << PipelineKeyHash()(key) << ", using the fallback: " << error << std::endl;
+				} else { std::cout << "Pipeline permutation " << PipelineKeyHash()(key) << " compiled in " << milliseconds << " ms" << std::endl; }
+			});
+		});
+		return fallback;
+	}
+
+	//Publishes finished builds without blocking, returns how many
+	size_t update() { return compiler.runCompletions(); }
+
+	size_t size() const { return entries.size(); }
+	size_t compiling() const { return compilingCount; }
+	size_t failed() const { return failedCount; }
+
+private:
+	struct Entry {
+		VkPipeline pipeline = VK_NULL_HANDLE; //Null while compiling or if the build failed
+	};
+
+	Build build;
+	Destroy destroy;
+	VkPipeline fallback;
+	std::unordered_map<PipelineKey, Entry, PipelineKeyHash> entries;
+	size_t compilingCount = 0;
+	size_t failedCount = 0;
+	AssetLoader compiler; //Last, so its workers are joined before the members their jobs use are destroyed
+};
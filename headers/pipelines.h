@@ -0,0 +1,48 @@
+//Pipeline permutations of the renderer, managed by pipelineLibrary (see pipelineLibrary.h) and compiled on its workers through the shared pipeline
+//cache. Until a permutation is ready its draws use graphicsPipeline, the fallback built at startup. Only the main thread touches pipelines
+PipelineKey fallbackPipelineKey() {
+	PipelineKey key{};
+		key.vertexShader = std::string(VERTEX_FORMAT == VertexFormat::Quantized ? "shaders/vert_quantized" : "shaders/vert") + (USE_INSTANCING ? "_instanced.spv" : ".spv");
+		key.fragmentShader = "shaders/frag.spv";
+		key.vertexFormat = VERTEX_FORMAT;
+		key.instanced = USE_INSTANCING;
+		key.cullMode = VK_CULL_MODE_BACK_BIT;
+		key.alphaBlend = false;
+		key.depthTest = true;
+		key.depthWrite = true;
+		key.samples = VK_SAMPLE_COUNT_1_BIT;
+	return key;
+}
+
+//Keys are checked where they are built, so a bad one fails at startup instead of in the per frame updatePipelines()
+void checkPipelineKey(const PipelineKey& key) {
+	if (key.samples != VK_SAMPLE_COUNT_1_BIT) { throw std::invalid_argument("pipeline sample count does not match the render pass!"); }
+}
+
+PipelineKey scenePipelineKey() {
+	PipelineKey key = fallbackPipelineKey();
+		key.cullMode = SCENE_CULL_MODE;
+		key.alphaBlend = SCENE_ALPHA_BLEND;
+	checkPipelineKey(key);
+	return key;
+}
+
+//After createGraphicsPipeline(), the library owns graphicsPipeline from here on. The scene permutation starts compiling right away
+void createPipelineLibrary() {
+	pipelineLibrary = std::make_unique<PipelineLibrary>(PIPELINE_COMPILER_THREADS, [this](const PipelineKey& key) { return buildGraphicsPipeline(key); },
+		[this](VkPipeline pipeline) { vkDestroyPipeline(device, pipeline, nullptr); }, fallbackPipelineKey(), graphicsPipeline);
+	scenePermutation = scenePipelineKey();
+	scenePipeline = pipelineLibrary->request(scenePermutation);
+}
+
+//Called once per frame, publishes finished compiles without blocking
+void updatePipelines() {
+	pipelineLibrary->update();
+	scenePipeline = pipelineLibrary->request(scenePermutation);
+}
+
+void destroyPipelines() {
+	pipelineLibrary.reset(); //Waits for running compiles, then destroys every permutation and graphicsPipeline
+	graphicsPipeline = VK_NULL_HANDLE;
+	scenePipeline = VK_NULL_HANDLE;
+}
@@ -0,0 +1,249 @@
+//Quadric error mesh simplification (Garland and Heckbert 1997) by half-edge collapses. Vertices only ever collapse onto existing vertices,
+//so every level of detail indexes the same vertex buffer
+
+struct MeshLod {
+	uint32_t firstIndex; //Into the shared index buffer
+	uint32_t indexCount;
+	float error; //Geometric error in model units, 0 for the full mesh
+};
+
+//Sum of squared distances to a set of planes, stored as the symmetric 4x4 matrix coefficients
+struct Quadric {
+	double a2 = 0, b2 = 0, c2 = 0, ab = 0, ac = 0, bc = 0, ad = 0, bd = 0, cd = 0, d2 = 0;
+	double weight = 0;
+
+	void addPlane(const glm::dvec3& normal, double distance, double planeWeight) {
+		a2 += planeWeight * normal.x * normal.x; b2 += planeWeight * normal.y * normal.y; c2 += planeWeight * normal.z * normal.z;
+		ab += planeWeight * normal.x * normal.y; ac += planeWeight * normal.x * normal.z; bc += planeWeight * normal.y * normal.z;
+		ad += planeWeight * normal.x * distance; bd += planeWeight * normal.y * distance; cd += planeWeight * normal.z * distance;
+		d2 += planeWeight * distance * distance;
+		weight += planeWeight;
+	}
+
+	void add(const Quadric& other) {
+		a2 += other.a2; b2 += other.b2; c2 += other.c2; ab += other.ab; ac += other.ac; bc += other.bc;
+		ad += other.ad; bd += other.bd; cd += other.cd; d2 += other.d2; weight += other.weight;
+	}
+
+	double evaluate(const glm::vec3& point) const {
+		double x = point.x, y = point.y, z = point.z;
+		return a2 * x * x + b2 * y * y + c2 * z * z + 2 * (ab * x * y + ac * x * z + bc * y * z) + 2 * (ad * x + bd * y + cd * z) + d2;
+	}
+};
+
+//Collapses cheapest first until the index count reaches targetIndexCount or nothing can collapse any more. Returns the new index list, error is set to the
+//square root of the largest weighted quadric error of any collapse, i.e. roughly how far the surface moved in model units.
+//Vertices are classified per position: interior vertices collapse freely, border vertices only along the border, UV seam vertices only along the seam
+//(both sides together) and anything more complex is locked
+inline std::vector<uint32_t> simplifyMesh(const std::vector<Vertex>& vertices, std::vector<uint32_t> indices, size_t targetIndexCount, float& error) {
+	enum class VertexKind : uint8_t { Manifold, Border, Seam, Locked };
+	const double borderWeight = 10.0;
+	error = 0.0f;
+
+	//Vertices that only differ in their UVs share a position id
+	std::vector<uint32_t> positionOf(vertices.size());
+	{
+		std::vector<uint32_t> order(vertices.size());
+		for (uint32_t i = 0; i < order.size(); i++) { order[i] = i; }
+		auto positionLess = [&vertices](uint32_t a, uint32_t b) {
+			const glm::vec3& p = vertices[a].pos;
+			const glm::vec3& q = vertices[b].pos;
+			return std::tie(p.x, p.y, p.z) < std::tie(q.x, q.y, q.z);
+		};
+		std::sort(order.begin(), order.end(), positionLess);
+		for (size_t i = 0, id = 0; i < order.size(); i++) {
+			if (i > 0 && positionLess(order[i - 1], order[i])) { id++; }
+			positionOf[order[i]] = static_cast<uint32_t>(id);
+		}
+	}
+	size_t positionCount = vertices.empty() ? 0 : *std::max_element(positionOf.begin(), positionOf.end()) + 1;
+	std::vector<glm::vec3> positions(positionCount);
+	for (size_t i = 0; i < vertices.size(); i++) { positions[positionOf[i]] = vertices[i].pos; }
+
+	auto edgeKey = [](uint32_t from, uint32_t to) { return (static_cast<uint64_t>(from) << 32) | to; };
+	struct EdgeUse {
+		uint32_t from; //Vertex (not position) at each end
+		uint32_t to;
+		uint32_t count;
+	};
+
+	//Triangle plane quadrics, plus planes perpendicular to the border so open edges keep their shape
+	std::vector<Quadric> quadrics(positionCount);
+	{
+		std::unordered_map<uint64_t, uint32_t> edgeCounts;
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			for (int corner = 0; corner < 3; corner++) { edgeCounts[edgeKey(positionOf[indices[i + corner]], positionOf[indices[i + (corner + 1) % 3]])]++; }
+		}
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			glm::dvec3 p[3];
+			for (int corner = 0; corner < 3; corner++) { p[corner] = glm::dvec3(vertices[indices[i + corner]].pos); }
+			glm::dvec3 normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+			double length = glm::length(normal);
+			if (length == 0.0) { continue; }
+			normal /= length;
+			for (int corner = 0; corner < 3; corner++) { quadrics[positionOf[indices[i + corner]]].addPlane(normal, -glm::dot(normal, p[0]), length * 0.5); }
+
+			for (int corner = 0; corner < 3; corner++) {
+				uint32_t from = positionOf[indices[i + corner]], to = positionOf[indices[i + (corner + 1) % 3]];
+				if (edgeCounts.count(edgeKey(to, from)) != 0) { continue; }
+				glm::dvec3 edge = p[(corner + 1) % 3] - p[corner];
+				glm::dvec3 borderNormal = glm::cross(edge, normal);
+				double borderLength = glm::length(borderNormal);
+				if (borderLength == 0.0) { continue; }
+				borderNormal /= borderLength;
+				double planeDistance = -glm::dot(borderNormal, p[corner]);
+				quadrics[from].addPlane(borderNormal, planeDistance, glm::dot(edge, edge) * borderWeight);
+				quadrics[to].addPlane(borderNormal, planeDistance, glm::dot(edge, edge) * borderWeight);
+			}
+		}
+	}
+
+	double maximumError = 0.0;
+	std::vector<uint32_t> remap(vertices.size());
+	std::vector<uint8_t> locked(positionCount);
+	std::vector<VertexKind> kinds(positionCount);
+	std::vector<uint32_t> wedgeCount(positionCount);
+	std::vector<uint32_t> wedgeMark(vertices.size());
+	std::vector<bool> onBorder(positionCount);
+	std::vector<uint32_t> triangleOffsets(positionCount + 1), triangleList;
+
+	while (indices.size() > targetIndexCount) {
+		size_t triangleCount = indices.size() / 3;
+
+		//Directed position edges with the vertices that use them
+		std::unordered_map<uint64_t, EdgeUse> edges;
+		edges.reserve(indices.size());
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			for (int corner = 0; corner < 3; corner++) {
+				uint32_t from = indices[i + corner], to = indices[i + (corner + 1) % 3];
+				auto inserted = edges.try_emplace(edgeKey(positionOf[from], positionOf[to]), EdgeUse{from, to, 0});
+				inserted.first->second.count++;
+			}
+		}
+
+		//Classify positions
+		std::fill(wedgeCount.begin(), wedgeCount.end(), 0);
+		std::fill(wedgeMark.begin(), wedgeMark.end(), 0);
+		std::fill(onBorder.begin(), onBorder.end(), false);
+		for (uint32_t index : indices) {
+			if (!wedgeMark[index]) { wedgeMark[index] = 1; wedgeCount[positionOf[index]]++; }
+		}
+		bool nonManifold = false;
+		for (const auto& edge : edges) {
+			uint32_t from = static_cast<uint32_t>(edge.first >> 32), to = static_cast<uint32_t>(edge.first);
+			if (edge.second.count > 1) { nonManifold = true; }
+			if (edges.count(edgeKey(to, from)) == 0) { onBorder[from] = onBorder[to] = true; }
+		}
+		for (size_t position = 0; position < positionCount; position++) {
+			if (wedgeCount[position] == 1) { kinds[position] = onBorder[position] ? VertexKind::Border : VertexKind::Manifold; }
+			else if (wedgeCount[position] == 2 && !onBorder[position]) { kinds[position] = VertexKind::Seam; }
+			else { kinds[position] = VertexKind::Locked; }
+		}
+		if (nonManifold) {
+			for (const auto& edge : edges) {
+				if (edge.second.count > 1) { kinds[edge.first >> 32] = kinds[static_cast<uint32_t>(edge.first)] = VertexKind::Locked; }
+			}
+		}
+
+		//Triangles around every position, for the flip test
+		std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+		for (uint32_t index : indices) { triangleOffsets[positionOf[index] + 1]++; }
+		for (size_t i = 0; i < positionCount; i++) { triangleOffsets[i + 1] += triangleOffsets[i]; }
+		triangleList.resize(indices.size());
+		{
+			std::vector<uint32_t> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+			for (size_t i = 0; i < indices.size(); i++) { triangleList[cursor[positionOf[indices[i]]]++] = static_cast<uint32_t>(i / 3); }
+		}
+
+		//Candidate collapses from every directed vertex edge
+		struct Collapse {
+			uint32_t from, to; //Vertices
+			uint32_t seamFrom, seamTo; //Other side of a seam, UINT32_MAX otherwise
+			double cost;
+		};
+		std::vector<Collapse> collapses;
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			for (int corner = 0; corner < 3; corner++) {
+				uint32_t from = indices[i + corner], to = indices[i + (corner + 1) % 3];
+				uint32_t fromPosition = positionOf[from], toPosition = positionOf[to];
+				if (fromPosition == toPosition) { continue; }
+
+				Collapse collapse{from, to, UINT32_MAX, UINT32_MAX, 0.0};
+				auto reverse = edges.find(edgeKey(toPosition, fromPosition));
+				VertexKind kind = kinds[fromPosition], toKind = kinds[toPosition];
+				if (kind == VertexKind::Locked) { continue; }
+				if (kind == VertexKind::Border && (reverse != edges.end() || toKind == VertexKind::Manifold || toKind == VertexKind::Seam)) { continue; }
+				if (kind == VertexKind::Seam) {
+					//Only along the seam: the triangle on the other side of this edge uses the other wedges of both positions
+					if (reverse == edges.end() || toKind == VertexKind::Manifold || toKind == VertexKind::Border) { continue; }
+					if (reverse->second.to == from || reverse->second.from == to) { continue; }
+					collapse.seamFrom = reverse->second.to;
+					collapse.seamTo = reverse->second.from;
+				}
+
+				Quadric quadric = quadrics[fromPosition];
+				quadric.add(quadrics[toPosition]);
+				collapse.cost = quadric.weight > 0.0 ? std::max(0.0, quadric.evaluate(positions[toPosition])) / quadric.weight : 0.0;
+				collapses.push_back(collapse);
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+		//Apply the cheapest collapses whose neighbourhoods do not overlap, each one removes about two triangles
+		for (uint32_t i = 0; i < remap.size(); i++) { remap[i] = i; }
+		std::fill(locked.begin(), locked.end(), 0);
+		size_t collapseGoal = std::max<size_t>(1, (triangleCount - targetIndexCount / 3) / 2);
+		size_t applied = 0;
+		//Many of the cheapest collapses get locked by a neighbour, so allow a bit more than the goal's cost instead of walking deep into expensive ones
+		double costLimit = collapseGoal < collapses.size() ? collapses[collapseGoal].cost * 1.5 : std::numeric_limits<double>::max();
+		for (const Collapse& collapse : collapses) {
+			if (applied >= collapseGoal || collapse.cost > costLimit) { break; }
+			uint32_t fromPosition = positionOf[collapse.from], toPosition = positionOf[collapse.to];
+			if (locked[fromPosition] || locked[toPosition]) { continue; }
+
+			//Reject collapses that flip a remaining triangle around the moving vertex
+			bool flips = false;
+			for (uint32_t t = triangleOffsets[fromPosition]; t < triangleOffsets[fromPosition + 1] && !flips; t++) {
+				uint32_t triangle = triangleList[t];
+				uint32_t p[3] = {positionOf[indices[triangle * 3]], positionOf[indices[triangle * 3 + 1]], positionOf[indices[triangle * 3 + 2]]};
+				if (p[0] == toPosition || p[1] == toPosition || p[2] == toPosition) { continue; }
+				glm::vec3 before[3], after[3];
+				for (int corner = 0; corner < 3; corner++) {
+					before[corner] = positions[p[corner]];
+					after[corner] = p[corner] == fromPosition ? positions[toPosition] : positions[p[corner]];
+				}
+				glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+				glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+				if (glm::dot(normalBefore, normalAfter) <= 0.0f) { flips = true; }
+			}
+			if (flips) { continue; }
+
+			remap[collapse.from] = collapse.to;
+			if (collapse.seamFrom != UINT32_MAX) { remap[collapse.seamFrom] = collapse.seamTo; }
+			quadrics[toPosition].add(quadrics[fromPosition]);
+			maximumError = std::max(maximumError, collapse.cost);
+			applied++;
+
+			//Lock the one-ring so the flip tests of later collapses in this pass stay valid
+			for (uint32_t t = triangleOffsets[fromPosition]; t < triangleOffsets[fromPosition + 1]; t++) {
+				uint32_t triangle = triangleList[t];
+				for (int corner = 0; corner < 3; corner++) { locked[positionOf[indices[triangle * 3 + corner]]] = 1; }
+			}
+		}
+		if (applied == 0) { break; }
+
+		//Rewrite the triangles and drop the ones that became degenerate
+		size_t write = 0;
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			uint32_t a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+			if (positionOf[a] == positionOf[b] || positionOf[b] == positionOf[c] || positionOf[a] == positionOf[c]) { continue; }
+			indices[write++] = a;
+			indices[write++] = b;
+			indices[write++] = c;
+		}
+		indices.resize(write);
+	}
+
+	error = static_cast<float>(std::sqrt(maximumError));
+	return indices;
+}
@@ -0,0 +1,304 @@
+//All uploads go through one persistently mapped staging buffer used as a ring. Copies, transitions and blits are recorded into an upload batch
+//that is submitted once with a fence, or a value on the upload timeline, the ring space is reclaimed once that signals, so uploads can keep streaming
+//while frames render. Upload tickets are the timeline values.
+//Copies run on the dedicated transfer queue if there is one, the batch then hands the resources over to the graphics queue
+void createStagingRing() {
+	createBuffer(STAGING_RING_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+	stagingRing = StagingRing(STAGING_RING_SIZE);
+	if (useTimelineSemaphores) { uploadTimeline = createTimelineSemaphore(); }
+}
+
+//Releases the ring space of finished submissions, waiting for the oldest one first if wait is set
+void reclaimStaging(bool wait) {
+	while (!stagingSubmissions.empty()) {
+		StagingSubmission& submission = stagingSubmissions.front();
+		if (wait) {
+			if (useTimelineSemaphores) { waitForTimeline(uploadTimeline, submission.ticket); }
+			else { vkWaitForFences(device, 1, &submission.fence, VK_TRUE, UINT64_MAX); }
+			wait = false;
+		} else if (useTimelineSemaphores ? timelineValue(uploadTimeline) < submission.ticket : vkGetFenceStatus(device, submission.fence) != VK_SUCCESS) { break; }
+
+		stagingRing.release(submission.ringPosition);
+		completedUploadTicket = submission.ticket;
+		if (!useTimelineSemaphores) { vkResetFences(device, 1, &submission.fence); }
+		idleStagingSubmissions.push_back(submission);
+		stagingSubmissions.pop_front();
+	}
+}
+
+//Blocks until the ring has room for size bytes. The open batch is submitted first if it holds the space that has to be reclaimed
+VkDeviceSize reserveStaging(VkDeviceSize size) {
+	VkDeviceSize offset;
+	while (!stagingRing.allocate(size, STAGING_ALIGNMENT, offset)) {
+		if (uploadBatch) { flushUploads(); }
+		if (stagingSubmissions.empty()) { throw std::runtime_error("failed to fit upload into staging ring!"); }
+		uploadStalls++;
+		reclaimStaging(true);
+	}
+	return offset;
+}
+
+StagingSubmission& openUploadBatch() {
+	if (uploadBatch) { return *uploadBatch; }
+
+	if (idleStagingSubmissions.empty()) {
+		StagingSubmission submission{};
+		VkCommandBufferAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocInfo.commandPool = transferCommandPool;
+			allocInfo.commandBufferCount = 1;
+		if (vkAllocateCommandBuffers(device, &allocInfo, &submission.commandBuffer) != VK_SUCCESS) { throw std::runtime_error("failed to allocate upload command buffer!"); }
+
+		VkFenceCreateInfo fenceInfo{};
+			fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		if (!useTimelineSemaphores && vkCreateFence(device, &fenceInfo, nullptr, &submission.fence) != VK_SUCCESS) { throw std::runtime_error("failed to create upload fence!"); }
+
+		//The graphics side of the batch: ownership acquires and whatever needs a graphics queue, started once the transfer side signals the semaphore
+		if (hasTransferQueue()) {
+			allocInfo.commandPool = commandPool;
+			if (vkAllocateCommandBuffers(device, &allocInfo, &submission.graphicsCommandBuffer) != VK_SUCCESS) { throw std::runtime_error("failed to allocate upload command buffer!"); }
+			VkSemaphoreCreateInfo semaphoreInfo{};
+				semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &submission.semaphore) != VK_SUCCESS) { throw std::runtime_error("failed to create upload semaphore!"); }
+		}
+		idleStagingSubmissions.push_back(submission);
+	}
+	uploadBatch = idleStagingSubmissions.back();
+	idleStagingSubmissions.pop_back();
+	uploadBatch->transferCommands = false;
+	uploadBatch->graphicsCommands = false;
+	return *uploadBatch;
+}
+
+void beginUploadCommandBuffer(VkCommandBuffer commandBuffer, uint32_t queueFamily, const char* profileName) {
+	VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	beginGpuProfiling(commandBuffer, queueFamily, profileName);
+}
+
+//Command buffer of the open upload batch for the transfer queue, opening a batch if needed. Copies and layout transitions recorded here all go out with
+//the next flushUploads()
+VkCommandBuffer uploadCommands() {
+	StagingSubmission& batch = openUploadBatch();
+	if (!batch.transferCommands) {
+		beginUploadCommandBuffer(batch.commandBuffer, queueFamilyIndices.transferFamily.value(), "upload");
+		batch.transferCommands = true;
+	}
+	return batch.commandBuffer;
+}
+
+//Same for commands that need a graphics queue, like blits. Without a separate transfer queue both are the same command buffer
+VkCommandBuffer graphicsUploadCommands() {
+	if (!hasTransferQueue()) { return uploadCommands(); }
+	StagingSubmission& batch = openUploadBatch();
+	if (!batch.graphicsCommands) {
+		beginUploadCommandBuffer(batch.graphicsCommandBuffer, queueFamilyIndices.graphicsFamily.value(), "upload_graphics");
+		batch.graphicsCommands = true;
+	}
+	return batch.graphicsCommandBuffer;
+}
+
+//Hands a range written on the transfer queue over to the graphics queue. Every upload target is freshly created, so there is never a release from
+//the graphics queue to pair with on the way in
+void transferBufferOwnership(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size) {
+	if (!hasTransferQueue()) { return; }
+	VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcQueueFamilyIndex = queueFamilyIndices.transferFamily.value();
+		barrier.dstQueueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+		barrier.buffer = buffer;
+		barrier.offset = offset;
+		barrier.size = size;
+
+	//Release
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = 0;
+	vkCmdPipelineBarrier(uploadCommands(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+	//Acquire
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+	vkCmdPipelineBarrier(graphicsUploadCommands(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+//Same for an image, which keeps its layout on the way over
+void transferImageOwnership(VkImage image, VkImageLayout layout, uint32_t mipLevels) {
+	if (!hasTransferQueue()) { return; }
+	VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = layout;
+		barrier.newLayout = layout;
+		barrier.srcQueueFamilyIndex = queueFamilyIndices.transferFamily.value();
+		barrier.dstQueueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = mipLevels;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+
+	//Release
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = 0;
+	vkCmdPipelineBarrier(uploadCommands(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	//Acquire
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(graphicsUploadCommands(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+//Submits the open batch and returns its ticket, or the ticket of the last batch if none is open. With a transfer queue the transfer side signals a
+//semaphore the graphics side waits on, so rendering is ordered after the upload on the GPU without the CPU waiting. A final barrier on the graphics
+//queue makes the uploads visible to everything submitted later
+UploadTicket flushUploads() {
+	if (!uploadBatch) { return nextUploadTicket - 1; }
+	if (!uploadBatch->transferCommands && !uploadBatch->graphicsCommands) {
+		idleStagingSubmissions.push_back(*uploadBatch);
+		uploadBatch.reset();
+		return nextUploadTicket - 1;
+	}
+
+	//Every batch ends with a submit to the graphics queue, also one holding only copies, like a batch reserveStaging() flushes in the middle of
+	//uploadToBuffer() before the acquire is recorded. Tickets are then signalled from one queue in submit order, a transfer only batch could otherwise
+	//signal its ticket while the graphics side of the batch before it is still pending and move the timeline backwards
+	VkCommandBuffer lastGraphicsCommands = graphicsUploadCommands();
+	StagingSubmission submission = *uploadBatch;
+	uploadBatch.reset();
+	VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+	vkCmdPipelineBarrier(lastGraphicsCommands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+	submission.ringPosition = stagingRing.position();
+	submission.ticket = nextUploadTicket++;
+
+	//The last submission of the batch signals the ticket on the upload timeline, or the batch fence
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = &submission.ticket;
+	VkFence completionFence = useTimelineSemaphores ? VK_NULL_HANDLE : submission.fence;
+
+	if (submission.transferCommands) {
+		bool last = !submission.graphicsCommands;
+		endGpuProfiling(submission.commandBuffer);
+		vkEndCommandBuffer(submission.commandBuffer);
+		VkSubmitInfo submitInfo{};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.pNext = last && useTimelineSemaphores ? &timelineInfo : nullptr;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &submission.commandBuffer;
+			submitInfo.signalSemaphoreCount = !last || useTimelineSemaphores ? 1 : 0;
+			submitInfo.pSignalSemaphores = last ? &uploadTimeline : &submission.semaphore;
+		if (vkQueueSubmit(transferQueue, 1, &submitInfo, last ? completionFence : VK_NULL_HANDLE) != VK_SUCCESS) { throw std::runtime_error("failed to submit upload batch!"); }
+		uploadSubmits++;
+	}
+	if (submission.graphicsCommands) {
+		endGpuProfiling(submission.graphicsCommandBuffer);
+		vkEndCommandBuffer(submission.graphicsCommandBuffer);
+		VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		VkSubmitInfo submitInfo{};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.pNext = useTimelineSemaphores ? &timelineInfo : nullptr;
+			submitInfo.waitSemaphoreCount = submission.transferCommands ? 1 : 0;
+			submitInfo.pWaitSemaphores = &submission.semaphore;
+			submitInfo.pWaitDstStageMask = &waitStage;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &submission.graphicsCommandBuffer;
+			submitInfo.signalSemaphoreCount = useTimelineSemaphores ? 1 : 0;
+			submitInfo.pSignalSemaphores = &uploadTimeline;
+		if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, completionFence) != VK_SUCCESS) { throw std::runtime_error("failed to submit upload batch!"); }
+		uploadSubmits++;
+	}
+
+	stagingSubmissions.push_back(submission);
+	return submission.ticket;
+}
+
+bool isUploadComplete(UploadTicket ticket) {
+	reclaimStaging(false);
+	return completedUploadTicket >= ticket;
+}
+
+void waitForUpload(UploadTicket ticket) {
+	if (isUploadComplete(ticket)) { return; }
+	uploadStalls++;
+	if (useTimelineSemaphores) { waitForTimeline(uploadTimeline, ticket); } //One wait for the ticket, not one per older batch
+	while (completedUploadTicket < ticket) { reclaimStaging(true); }
+}
+
+//End of one upload operation. With BATCH_UPLOADS off every operation is submitted and waited for on its own, like the old single time commands
+void finishUploadCommands() {
+	if (!BATCH_UPLOADS) { waitForUpload(flushUploads()); }
+}
+
+void reportUploadStats(const char* phase) {
+	std::cout << phase << " uploads: " << uploadSubmits << " submits, " << uploadStalls << " CPU stalls" << (BATCH_UPLOADS ? " (batched)" : " (one submit per operation)") << std::endl;
+}
+
+//Copies size bytes into dstBuffer at dstOffset, in chunks of at most a quarter of the ring so a full ring only has to wait for part of the data
+void uploadToBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size) {
+	const VkDeviceSize chunkSize = stagingRing.capacity() / 4;
+	for (VkDeviceSize done = 0; done < size; ) {
+		VkDeviceSize chunk = std::min(chunkSize, size - done);
+		VkDeviceSize offset = reserveStaging(chunk);
+		memcpy(static_cast<char*>(stagingBufferMemory.mapped) + offset, static_cast<const char*>(data) + done, static_cast<size_t>(chunk));
+
+		VkCommandBuffer commandBuffer = uploadCommands();
+		VkBufferCopy copyRegion{};
+			copyRegion.srcOffset = offset;
+			copyRegion.dstOffset = dstOffset + done;
+			copyRegion.size = chunk;
+		vkCmdCopyBuffer(commandBuffer, stagingBuffer, dstBuffer, 1, &copyRegion);
+		done += chunk;
+	}
+	transferBufferOwnership(dstBuffer, dstOffset, size);
+	finishUploadCommands();
+}
+
+//Copies tightly packed pixels into mip level 0 of an image in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, chunked by rows
+void uploadToImage(VkImage image, uint32_t width, uint32_t height, uint32_t bytesPerPixel, const void* data) {
+	const VkDeviceSize rowSize = static_cast<VkDeviceSize>(width) * bytesPerPixel;
+	const uint32_t chunkRows = static_cast<uint32_t>(std::max<VkDeviceSize>(1, stagingRing.capacity() / 4 / rowSize));
+	for (uint32_t row = 0; row < height; ) {
+		uint32_t rows = std::min(chunkRows, height - row);
+		VkDeviceSize offset = reserveStaging(rows * rowSize);
+		memcpy(static_cast<char*>(stagingBufferMemory.mapped) + offset, static_cast<const char*>(data) + row * rowSize, static_cast<size_t>(rows * rowSize));
+
+		VkCommandBuffer commandBuffer = uploadCommands();
+		VkBufferImageCopy region{};
+			region.bufferOffset = offset;
+			//Specify how the pixels are laid out in memory. For example, you could have some padding bytes between rows of the image. Specifying 0 for both indicates that the pixels are simply tightly packed
+			region.bufferRowLength = 0;
+			region.bufferImageHeight = 0;
+			//Indicate to which part of the image we want to copy the pixels
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = 0;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+			region.imageOffset = {0, static_cast<int32_t>(row), 0};
+			region.imageExtent = {width, rows, 1};
+		vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+		row += rows;
+	}
+	finishUploadCommands();
+}
+
+void destroyStagingRing() {
+	flushUploads();
+	while (!stagingSubmissions.empty()) { reclaimStaging(true); }
+	for (const StagingSubmission& submission : idleStagingSubmissions) {
+		vkDestroyFence(device, submission.fence, nullptr);
+		vkFreeCommandBuffers(device, transferCommandPool, 1, &submission.commandBuffer);
+		if (submission.graphicsCommandBuffer != VK_NULL_HANDLE) {
+			vkFreeCommandBuffers(device, commandPool, 1, &submission.graphicsCommandBuffer);
+			vkDestroySemaphore(device, submission.semaphore, nullptr);
+		}
+	}
+	idleStagingSubmissions.clear();
+	vkDestroySemaphore(device, uploadTimeline, nullptr);
+	destroyBuffer(stagingBuffer, stagingBufferMemory);
+}
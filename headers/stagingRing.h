@@ -0,0 +1,45 @@
+//Space bookkeeping of the staging ring buffer. head and tail count bytes since creation, so head - tail is the space in flight and
+//position % capacity the offset in the buffer. An allocation never wraps around the end, it skips to the start of the buffer instead
+class StagingRing {
+public:
+	explicit StagingRing(uint64_t capacity = 0) : size(capacity) {}
+
+	//Returns false if there is not enough contiguous space until earlier submissions are released
+	bool allocate(uint64_t bytes, uint64_t alignment, uint64_t& offset) {
+		if (bytes == 0 || bytes > size) { return false; }
+		uint64_t headOffset = head % size;
+		uint64_t alignedOffset = (headOffset + alignment - 1) / alignment * alignment;
+		uint64_t start = head - headOffset + alignedOffset;
+		if (alignedOffset + bytes > size) { start = (head / size + 1) * size; }
+		if (start + bytes - tail > size) { return false; }
+		head = start + bytes;
+		offset = start % size;
+		return true;
+	}
+
+	//Position to release once the GPU is done with everything allocated so far
+	uint64_t position() const { return head; }
+	void release(uint64_t position) { tail = std::max(tail, position); }
+
+	uint64_t capacity() const { return size; }
+	uint64_t used() const { return head - tail; }
+
+private:
+	uint64_t size;
+	uint64_t head = 0;
+	uint64_t tail = 0;
+};
+
+//Identifies one submitted upload batch, tickets grow by one per batch so every ticket up to the last completed one is done
+using UploadTicket = uint64_t;
+
+struct StagingSubmission {
+	VkCommandBuffer commandBuffer; //Transfer queue
+	VkCommandBuffer graphicsCommandBuffer; //Only with a separate transfer queue
+	VkSemaphore semaphore; //Transfer side to graphics side
+	VkFence fence; //Signaled by the last submission of the batch
+	bool transferCommands; //Which command buffers were recorded into
+	bool graphicsCommands;
+	uint64_t ringPosition; //StagingRing::position() right after the submission, released when the fence signals
+	UploadTicket ticket;
+};
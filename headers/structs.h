@@ -7,10 +7,48 @@ struct SwapChainSupportDetails {
 struct QueueFamilyIndices {
 	std::optional<uint32_t> graphicsFamily;
 	std::optional<uint32_t> presentFamily;
+	std::optional<uint32_t> transferFamily; //Without graphics, only set if the device has one
 
 	bool isComplete() { return graphicsFamily.has_value() && presentFamily.has_value(); }
 };
 
+struct SwapchainStats {
+	uint32_t recreations = 0;
+	uint32_t depthReuses = 0;
+	double recreateTime = 0.0; //Milliseconds of CPU time in recreateSwapChain(), summed
+	double maxRecreateTime = 0.0;
+	uint32_t resizes = 0; //Resizes that reached a presented frame
+	double resizeLatency = 0.0; //Milliseconds from the resize to the first frame presented at the new size, summed
+	double maxResizeLatency = 0.0;
+};
+
+//Milliseconds of CPU time spent in each drawFrame() stage
+struct FrameTiming {
+	double fenceWait = 0.0; //waitForFrameSlot()
+	double acquire = 0.0;
+	double update = 0.0; //Deletions, asset streaming, descriptor refresh, updateUniformBuffer() and the upload flush
+	double record = 0.0;
+	double submit = 0.0;
+	double present = 0.0; //Includes swapchain recreation when present asks for it
+	double total = 0.0;
+};
+
+enum class ModelLoader {
+	TinyObj, //Single threaded tinyobjloader
+	Parallel, //Line-aligned chunks parsed on all cores
+	Mapped //Single pass over a memory-mapped file with no intermediate containers
+};
+
+enum class RenderPath {
+	Indexed, //One draw per index range
+	Meshlets //One draw per meshlet that survives CPU frustum and normal cone culling
+};
+
+enum class VertexFormat {
+	Full, //Vertex, 32 bytes
+	Quantized //QuantizedVertex, 12 bytes. Positions are 16-bit unorm relative to the mesh bounds, UVs are half floats, the constant color is dropped
+};
+
 struct Vertex {
 	glm::vec3 pos;
 	glm::vec3 color;
@@ -50,8 +88,80 @@ struct Vertex {
 	}
 };
 
+//Only used by the benchmarks as the unordered_map baseline, the loaders weld with hashVertex()
+namespace std {
+	template<> struct hash<Vertex> {
+		size_t operator()(Vertex const& vertex) const {
+			return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^ (hash<glm::vec2>()(vertex.texCoord) << 1);
+		}
+	};
+}
+
+//GPU layout of VertexFormat::Quantized
+struct QuantizedVertex {
+	uint16_t pos[4]; //xyz unorm, w unused. Four components because R16G16B16_UNORM vertex fetch is optional while R16G16B16A16_UNORM is required
+	uint16_t texCoord[2]; //Half floats
+
+	static VkVertexInputBindingDescription getBindingDescription() {
+		VkVertexInputBindingDescription bindingDescription{};
+			bindingDescription.binding = 0;
+			bindingDescription.stride = sizeof(QuantizedVertex);
+			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		return bindingDescription;
+	}
+
+	static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions() {
+		std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
+		//Position, dequantized in the vertex shader
+		attributeDescriptions[0].binding = 0;
+		attributeDescriptions[0].location = 0;
+		attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+		attributeDescriptions[0].offset = offsetof(QuantizedVertex, pos);
+		//UV coordinates
+		attributeDescriptions[1].binding = 0;
+		attributeDescriptions[1].location = 2;
+		attributeDescriptions[1].format = VK_FORMAT_R16G16_SFLOAT;
+		attributeDescriptions[1].offset = offsetof(QuantizedVertex, texCoord);
+
+		return attributeDescriptions;
+	}
+};
+
+//Per instance model matrix for the instanced path, read as four vec4 attributes from a second vertex binding
+struct InstanceData {
+	glm::mat4 model;
+
+	static VkVertexInputBindingDescription getBindingDescription() {
+		VkVertexInputBindingDescription bindingDescription{};
+			bindingDescription.binding = 1;
+			bindingDescription.stride = sizeof(InstanceData);
+			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+		return bindingDescription;
+	}
+
+	static std::array<VkVertexInputAttributeDescription, 4> getAttributeDescriptions() {
+		std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions{};
+		//One column per location, after the vertex attributes
+		for (uint32_t column = 0; column < 4; column++) {
+			attributeDescriptions[column].binding = 1;
+			attributeDescriptions[column].location = 3 + column;
+			attributeDescriptions[column].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+			attributeDescriptions[column].offset = static_cast<uint32_t>(offsetof(InstanceData, model) + sizeof(glm::vec4) * column);
+		}
+		return attributeDescriptions;
+	}
+};
+
+//position = offset + unorm * scale
+struct VertexQuantization {
+	glm::vec3 offset;
+	glm::vec3 scale;
+};
+
 struct UniformBufferObject {
 	alignas(16) glm::mat4 model;
 	alignas(16) glm::mat4 view;
 	alignas(16) glm::mat4 proj;
+	alignas(16) glm::vec4 positionOffset; //VertexQuantization, only read by the quantized vertex shader
+	alignas(16) glm::vec4 positionScale;
 };
@@ -51,6 +51,7 @@ VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities, GLFWwi
 }
 
 void createSwapchain() {
+	if (HEADLESS) { createOffscreenTargets(); return; }
 	SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice);
 
 	VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
@@ -85,7 +86,7 @@ void createSwapchain() {
 		swapchainInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 		swapchainInfo.presentMode = presentMode;
 		swapchainInfo.clipped = VK_TRUE;
-		swapchainInfo.oldSwapchain = VK_NULL_HANDLE;
+		swapchainInfo.oldSwapchain = swapChain; //Retired by recreateSwapChain(), lets the driver hand over resources and keep presenting meanwhile
 
 	//Create
 	if (vkCreateSwapchainKHR(device, &swapchainInfo, nullptr, &swapChain) != VK_SUCCESS) { throw std::runtime_error("failed to create swap chain!"); }
@@ -100,18 +101,57 @@ void createSwapchain() {
 }
 
 void recreateSwapChain() {
+	TraceScope traceScope("recreateSwapChain", "swapchain");
 	int width = 0, height = 0;
 	glfwGetFramebufferSize(window, &width, &height);
 	while (width == 0 || height == 0) {
 		glfwGetFramebufferSize(window, &width, &height);
 		glfwWaitEvents();
 	}
-	vkDeviceWaitIdle(device);
-
-	cleanupSwapchain();
-
+	//No device drain, frames in flight keep rendering into the old swapchain while its views, framebuffers and the swapchain itself are retired
+	auto startTime = std::chrono::high_resolution_clock::now();
+	VkExtent2D oldExtent = swapChainExtent;
+	cleanupSwapchain(true);
 	createSwapchain();
 	createImageViews();
-	createDepthResources();
+
+	//The depth image is only written inside the render area, so it can be reused while the new extent fits and it is not much bigger than needed
+	uint64_t depthArea = static_cast<uint64_t>(depthExtent.width) * depthExtent.height;
+	uint64_t neededArea = static_cast<uint64_t>(swapChainExtent.width) * swapChainExtent.height;
+	bool reuseDepth = swapChainExtent.width <= depthExtent.width && swapChainExtent.height <= depthExtent.height && depthArea <= neededArea * 2;
+	if (reuseDepth) { swapchainStats.depthReuses++; }
+	else {
+		deferDestroyImageView(depthImageView);
+		deferDestroyImage(depthImage, depthImageMemory);
+		createDepthResources();
+	}
 	createFramebuffers();
+
+	double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	swapchainStats.recreations++;
+	swapchainStats.recreateTime += milliseconds;
+	swapchainStats.maxRecreateTime = std::max(swapchainStats.maxRecreateTime, milliseconds);
+	if (oldExtent.width != swapChainExtent.width || oldExtent.height != swapChainExtent.height) { swapchainRecreatedForResize = true; }
+	else if (!swapchainRecreatedForResize) { resizeStartTime.reset(); } //Out of date without a new size, not a resize
+}
+
+//Ends the resize latency measurement at the first frame presented on a swapchain of the new size
+void notePresent() {
+	if (!resizeStartTime || !swapchainRecreatedForResize) { return; }
+	double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - *resizeStartTime).count();
+	swapchainStats.resizes++;
+	swapchainStats.resizeLatency += milliseconds;
+	swapchainStats.maxResizeLatency = std::max(swapchainStats.maxResizeLatency, milliseconds);
+	resizeStartTime.reset();
+	swapchainRecreatedForResize = false;
+}
+
+void reportSwapchainStats() {
+	if (swapchainStats.recreations == 0) { return; }
+	std::cout << "Swapchain recreations: " << swapchainStats.recreations << ", " << swapchainStats.recreateTime / swapchainStats.recreations << " ms mean, "
+		<< swapchainStats.maxRecreateTime << " ms max, depth image reused " << swapchainStats.depthReuses << " times" << std::endl;
+	if (swapchainStats.resizes > 0) {
+		std::cout << "Resize to present latency: " << swapchainStats.resizes << " resizes, " << swapchainStats.resizeLatency / swapchainStats.resizes << " ms mean, "
+			<< swapchainStats.maxResizeLatency << " ms max" << std::endl;
+	}
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
+//With timeline semaphores every graphics frame signals frameTimeline with its frame number and every upload batch signals uploadTimeline with its
+//ticket, the CPU waits for counter values instead of fences. The binary semaphores stay, acquire and present only take binary semaphores
 void createSyncObjects() {
-	imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-	renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-	inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+	imageAvailableSemaphores.resize(framesInFlight);
+	renderFinishedSemaphores.resize(framesInFlight);
+	inFlightFences.assign(framesInFlight, VK_NULL_HANDLE);
 
 	VkSemaphoreCreateInfo semaphoreInfo{};
 		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -10,9 +12,58 @@ void createSyncObjects() {
 		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
 		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT; //Create fence in signaled state so the very first frame does not get blocked
 
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+	for (size_t i = 0; i < framesInFlight; i++) {
 		if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
 			vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-			vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) { throw std::runtime_error("failed to create semaphores!"); }
+			(!useTimelineSemaphores && vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS)) { throw std::runtime_error("failed to create semaphores!"); }
 	}
+	if (useTimelineSemaphores && frameTimeline == VK_NULL_HANDLE) { frameTimeline = createTimelineSemaphore(); } //Outlives changes of framesInFlight
+}
+
+VkSemaphore createTimelineSemaphore() {
+	VkSemaphoreTypeCreateInfo typeInfo{};
+		typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo{};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = &typeInfo;
+
+	VkSemaphore semaphore;
+	if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) { throw std::runtime_error("failed to create timeline semaphore!"); }
+	return semaphore;
+}
+
+uint64_t timelineValue(VkSemaphore semaphore) {
+	uint64_t value = 0;
+	vkGetSemaphoreCounterValue(device, semaphore, &value);
+	return value;
+}
+
+void waitForTimeline(VkSemaphore semaphore, uint64_t value) {
+	VkSemaphoreWaitInfo waitInfo{};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &semaphore;
+		waitInfo.pValues = &value;
+	vkWaitSemaphores(device, &waitInfo, UINT64_MAX);
+}
+
+//Blocks until the frame slot about to be recorded is free again, that is until the GPU finished the frame framesInFlight submissions back. The time
+//spent blocked is kept in lastFrameWaitTime
+void waitForFrameSlot() {
+	auto startTime = std::chrono::high_resolution_clock::now();
+	if (useTimelineSemaphores) {
+		if (frameNumber + 1 > framesInFlight) { waitForTimeline(frameTimeline, frameNumber + 1 - framesInFlight); }
+	} else {
+		vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX); //VK_TRUE parameter indicates waiting for all fences, UINT64_MAX effectively disables timeout
+		if (frameNumber + 1 > framesInFlight) { fenceCompletedFrame = frameNumber + 1 - framesInFlight; }
+	}
+	lastFrameWaitTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+//Newest frame number the GPU has finished. Fences only tell about the frame whose slot was waited on last
+uint64_t completedFrameNumber() {
+	return useTimelineSemaphores ? timelineValue(frameTimeline) : fenceCompletedFrame;
 }
\ No newline at end of file
@@ -1,6 +1,4 @@
 void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels) {
-	VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
 	VkImageMemoryBarrier barrier{};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
 	//The first two fields specify layout transition. It is possible to use VK_IMAGE_LAYOUT_UNDEFINED as oldLayout if you don’t care about the existing contents of the image.
@@ -33,6 +31,7 @@ void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayo
 		sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
 		destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
 	} else { throw std::invalid_argument("unsupported layout transition!"); }
+	VkCommandBuffer commandBuffer = destinationStage == VK_PIPELINE_STAGE_TRANSFER_BIT ? uploadCommands() : graphicsUploadCommands();
 
 	vkCmdPipelineBarrier(
 		commandBuffer,
@@ -42,37 +41,20 @@ void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayo
 		0, nullptr,
 		1, &barrier
 	);
-	endSingleTimeCommands(commandBuffer);
+	finishUploadCommands();
 }
 
-void createTextureImage() {
-	int texWidth, texHeight, texChannels;
-	stbi_uc* pixels = stbi_load(TEXTURE_PATH.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-	VkDeviceSize imageSize = texWidth * texHeight * 4;
+//Takes the RGBA pixels decoded by the asset loader
+void createTextureImage(const stbi_uc* pixels, int texWidth, int texHeight) {
 	//Calculate number of levels in Mip chain
 	mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
 
-	if (!pixels) { throw std::runtime_error("failed to load texture image!"); }
-
-	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
-	createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-	void* data;
-	vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-	memcpy(data, pixels, static_cast<size_t>(imageSize));
-	vkUnmapMemory(device, stagingBufferMemory);
-
-	stbi_image_free(pixels);
-
 	createImage(texWidth, texHeight, mipLevels, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageMemory);
 
 	//Prepare the texture image
 	transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
-	copyBufferToImage(stagingBuffer, textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-
-	vkDestroyBuffer(device, stagingBuffer, nullptr);
-	vkFreeMemory(device, stagingBufferMemory, nullptr);
+	uploadToImage(textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 4, pixels);
+	transferImageOwnership(textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels); //Blits need the graphics queue
 
 	generateMipmaps(textureImage, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, mipLevels);
 }
\ No newline at end of file
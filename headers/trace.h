@@ -0,0 +1,132 @@
+//Chrome trace_event recording, opened in chrome://tracing or ui.perfetto.dev. Every thread appends complete events to a fixed size buffer of its own
+//without locks, the registry mutex is only taken the first time a thread records. While tracing is off a scope costs one relaxed atomic load.
+//start() has to come before any other thread records, writeJson() after they are done
+class Trace {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static void start(size_t eventsPerThread) {
+		capacity = eventsPerThread;
+		active.store(true, std::memory_order_relaxed);
+	}
+
+	static bool enabled() { return active.load(std::memory_order_relaxed); }
+
+	//Nanoseconds on the trace clock
+	static int64_t timestamp(Clock::time_point time) { return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count(); }
+	static int64_t now() { return timestamp(Clock::now()); }
+
+	//name and category must outlive the trace, string literals
+	static void complete(const char* name, const char* category, int64_t start, int64_t end) {
+		if (enabled()) { append(threadBuffer(), {name, category, start, end}); }
+	}
+
+	//Events on the GPU track, already moved to the trace clock. Only one thread may add them
+	static void gpuComplete(const char* name, int64_t start, int64_t end) {
+		if (enabled()) { append(gpuBuffer(), {name, "gpu", start, end}); }
+	}
+
+	static void nameThread(const char* name) {
+		if (enabled()) { threadBuffer().name = name; }
+	}
+
+	//Returns the number of events dropped because a buffer was full
+	static uint64_t writeJson(const std::string& path) {
+		std::lock_guard<std::mutex> lock(registryMutex);
+		int64_t origin = std::numeric_limits<int64_t>::max();
+		for (const auto& buffer : buffers) {
+			size_t count = buffer->count.load(std::memory_order_acquire);
+			for (size_t i = 0; i < count; i++) { origin = std::min(origin, buffer->events[i].start); }
+		}
+
+		std::ofstream file(path, std::ios::trunc);
+		if (!file) { throw std::runtime_error("failed to open trace output " + path + "!"); }
+		file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+		uint64_t dropped = 0;
+		bool first = true;
+		for (const auto& buffer : buffers) {
+			file << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->id << ", \"args\": {\"name\": \"" << buffer->name << "\"}}";
+			first = false;
+			size_t count = buffer->count.load(std::memory_order_acquire);
+			for (size_t i = 0; i < count; i++) {
+				const Event& event = buffer->events[i];
+				file << ",\n{\"name\": \"" << event.name << "\", \"cat\": \"" << event.category << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->id
+					<< ", \"ts\": " << (event.start - origin) / 1000.0 << ", \"dur\": " << (event.end - event.start) / 1000.0 << "}";
+			}
+			dropped += buffer->dropped.load(std::memory_order_relaxed);
+		}
+		file << "\n]}\n";
+		if (!file) { throw std::runtime_error("failed to write trace output " + path + "!"); }
+		return dropped;
+	}
+
+private:
+	struct Event {
+		const char* name;
+		const char* category;
+		int64_t start;
+		int64_t end;
+	};
+
+	//Only the owning thread writes, count is published with release so writeJson() sees complete events
+	struct Buffer {
+		uint32_t id;
+		std::string name;
+		std::unique_ptr<Event[]> events;
+		std::atomic<size_t> count{0};
+		std::atomic<uint64_t> dropped{0};
+	};
+
+	static inline std::atomic<bool> active{false};
+	static inline size_t capacity = 0;
+	static inline std::mutex registryMutex;
+	static inline std::vector<std::unique_ptr<Buffer>> buffers; //Outlive their threads, workers are gone by the time the trace is written
+
+	static Buffer& registerBuffer(const char* name) {
+		std::lock_guard<std::mutex> lock(registryMutex);
+		auto buffer = std::make_unique<Buffer>();
+		buffer->id = static_cast<uint32_t>(buffers.size() + 1);
+		buffer->name = name;
+		buffer->events = std::make_unique<Event[]>(capacity);
+		buffers.push_back(std::move(buffer));
+		return *buffers.back();
+	}
+
+	static Buffer& threadBuffer() {
+		thread_local Buffer* buffer = &registerBuffer("worker");
+		return *buffer;
+	}
+
+	static Buffer& gpuBuffer() {
+		static Buffer& buffer = registerBuffer("GPU");
+		return buffer;
+	}
+
+	static void append(Buffer& buffer, const Event& event) {
+		size_t index = buffer.count.load(std::memory_order_relaxed);
+		if (index >= capacity) { buffer.dropped.fetch_add(1, std::memory_order_relaxed); return; }
+		buffer.events[index] = event;
+		buffer.count.store(index + 1, std::memory_order_release);
+	}
+};
+
+//Records the lifetime of the object as one event
+class TraceScope {
+public:
+	TraceScope(const char* name, const char* category) : name(name), category(category), start(Trace::enabled() ? Trace::now() : -1) {}
+
+	~TraceScope() {
+		if (start >= 0) { Trace::complete(name, category, start, Trace::now()); }
+	}
+
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+	const char* name;
+	const char* category;
+	int64_t start;
+};
+
+//Records one startup statement as an "init" event named after its source text, TRACE_STEP(createDevice()) shows up as "createDevice()"
+#define TRACE_STEP(statement) do { TraceScope traceStep(#statement, "init"); statement; } while (0)
@@ -0,0 +1,54 @@
+//Tracing (TRACING). CPU scopes are recorded with TraceScope/TRACE_STEP on any thread, GPU_PROFILING scopes are added on a GPU track by
+//collectGpuTimings() once they are read back, moved onto the trace clock by gpuClockOffset
+void startTracing() {
+	if (!TRACING) { return; }
+	Trace::start(TRACE_EVENTS_PER_THREAD);
+	Trace::nameThread("main");
+}
+
+//A single timestamp is submitted and waited for. It was written somewhere between the submit and the end of the wait, so taking the midpoint is off
+//by at most half that round trip. Clock drift over long captures is not corrected
+void calibrateGpuClock() {
+	if (!TRACING || !gpuProfiler) { return; }
+
+	VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = commandPool;
+		allocInfo.commandBufferCount = 1;
+	VkCommandBuffer commandBuffer;
+	if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS) { throw std::runtime_error("failed to allocate calibration command buffer!"); }
+
+	VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	beginGpuProfiling(commandBuffer, queueFamilyIndices.graphicsFamily.value(), "calibration");
+	endGpuProfiling(commandBuffer);
+	vkEndCommandBuffer(commandBuffer);
+
+	VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+	int64_t submitTime = Trace::now();
+	if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) { throw std::runtime_error("failed to submit calibration command buffer!"); }
+	vkQueueWaitIdle(graphicsQueue);
+	int64_t completeTime = Trace::now();
+	vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+
+	gpuProfiler->collect();
+	for (const GpuTiming& timing : gpuProfiler->takeResults()) {
+		if (std::strcmp(timing.name, "calibration") == 0) {
+			gpuClockOffset = (submitTime + completeTime) / 2 - static_cast<int64_t>(timing.begin);
+			std::cout << "GPU clock calibrated to within " << (completeTime - submitTime) / 2000.0 << " us" << std::endl;
+		}
+	}
+}
+
+void writeTrace() {
+	if (!TRACING) { return; }
+	uint64_t dropped = Trace::writeJson(TRACE_OUTPUT);
+	std::cout << "Trace written to " << TRACE_OUTPUT << std::endl;
+	if (dropped > 0) { std::cerr << dropped << " trace events dropped, raise TRACE_EVENTS_PER_THREAD" << std::endl; }
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+//Conversion from Vertex to QuantizedVertex and the CPU side error measurement for it
+
+struct QuantizationError {
+	float maxPositionError; //Model units
+	float meanPositionError;
+	float maxTexCoordError;
+	float meanTexCoordError;
+	float boundsDiagonal;
+};
+
+//The mesh bounds become the unit cube of the 16-bit positions
+inline VertexQuantization computeVertexQuantization(const std::vector<Vertex>& vertices) {
+	VertexQuantization quantization{glm::vec3(0.0f), glm::vec3(1.0f)};
+	if (vertices.empty()) { return quantization; }
+
+	glm::vec3 minimum = vertices[0].pos, maximum = vertices[0].pos;
+	for (const Vertex& vertex : vertices) {
+		minimum = glm::min(minimum, vertex.pos);
+		maximum = glm::max(maximum, vertex.pos);
+	}
+	quantization.offset = minimum;
+	quantization.scale = maximum - minimum;
+	return quantization;
+}
+
+inline uint16_t quantizeUnorm16(float value) {
+	return static_cast<uint16_t>(std::lround(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f));
+}
+
+inline QuantizedVertex quantizeVertex(const Vertex& vertex, const VertexQuantization& quantization) {
+	QuantizedVertex quantized{};
+	for (int axis = 0; axis < 3; axis++) {
+		float scale = quantization.scale[axis];
+		quantized.pos[axis] = quantizeUnorm16(scale > 0.0f ? (vertex.pos[axis] - quantization.offset[axis]) / scale : 0.0f);
+	}
+	quantized.texCoord[0] = glm::packHalf1x16(vertex.texCoord.x);
+	quantized.texCoord[1] = glm::packHalf1x16(vertex.texCoord.y);
+	return quantized;
+}
+
+//Same math as shaders/shader_quantized.vert
+inline glm::vec3 dequantizePosition(const QuantizedVertex& vertex, const VertexQuantization& quantization) {
+	glm::vec3 unorm(vertex.pos[0] / 65535.0f, vertex.pos[1] / 65535.0f, vertex.pos[2] / 65535.0f);
+	return quantization.offset + unorm * quantization.scale;
+}
+
+inline std::vector<QuantizedVertex> quantizeVertices(const std::vector<Vertex>& vertices, const VertexQuantization& quantization) {
+	std::vector<QuantizedVertex> quantized(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++) { quantized[i] = quantizeVertex(vertices[i], quantization); }
+	return quantized;
+}
+
+inline QuantizationError measureQuantizationError(const std::vector<Vertex>& vertices, const std::vector<QuantizedVertex>& quantized, const VertexQuantization& quantization) {
+	QuantizationError error{};
+	error.boundsDiagonal = glm::length(quantization.scale);
+	if (vertices.empty()) { return error; }
+
+	double positionSum = 0.0, texCoordSum = 0.0;
+	for (size_t i = 0; i < vertices.size(); i++) {
+		float positionError = glm::length(dequantizePosition(quantized[i], quantization) - vertices[i].pos);
+		glm::vec2 texCoord(glm::unpackHalf1x16(quantized[i].texCoord[0]), glm::unpackHalf1x16(quantized[i].texCoord[1]));
+		float texCoordError = std::max(std::abs(texCoord.x - vertices[i].texCoord.x), std::abs(texCoord.y - vertices[i].texCoord.y));
+
+		error.maxPositionError = std::max(error.maxPositionError, positionError);
+		error.maxTexCoordError = std::max(error.maxTexCoordError, texCoordError);
+		positionSum += positionError;
+		texCoordSum += texCoordError;
+	}
+	error.meanPositionError = static_cast<float>(positionSum / vertices.size());
+	error.meanTexCoordError = static_cast<float>(texCoordSum / vertices.size());
+	return error;
+}
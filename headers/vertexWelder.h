@@ -0,0 +1,184 @@
+//Vertex deduplication ("welding") on a flat open-addressing table. Slots hold the upper 32 hash bits as a tag and the vertex index, so a probe touches one cache line and only compares full vertices when the tags match
+
+//Hash over the raw float bits. Adding 0.0f folds -0.0 into +0.0 so vertices that compare equal with operator== always hash equal
+inline uint64_t hashVertex(const Vertex& vertex) {
+	const uint64_t prime1 = 11400714785074694791ULL;
+	const uint64_t prime2 = 14029467366897019727ULL;
+	const uint64_t prime3 = 1609587929392839161ULL;
+
+	float values[8] = {
+		vertex.pos.x + 0.0f, vertex.pos.y + 0.0f, vertex.pos.z + 0.0f,
+		vertex.color.x + 0.0f, vertex.color.y + 0.0f, vertex.color.z + 0.0f,
+		vertex.texCoord.x + 0.0f, vertex.texCoord.y + 0.0f
+	};
+	uint64_t words[4];
+	memcpy(words, values, sizeof(words));
+
+	uint64_t hash = prime3;
+	for (uint64_t word : words) { hash = rotateLeft64(hash ^ (word * prime2), 31) * prime1; }
+	hash ^= hash >> 33;
+	hash *= prime2;
+	hash ^= hash >> 29;
+	hash *= prime3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+class VertexWelder {
+public:
+	//Unique vertices are appended to vertices in first-seen order
+	VertexWelder(std::vector<Vertex>& vertices, size_t expectedVertexCount = 0) : vertices(vertices) {
+		size_t slotCount = 64;
+		while (slotCount < expectedVertexCount * 2) { slotCount *= 2; }
+		slots.assign(slotCount, Slot{0, EMPTY_SLOT});
+		mask = slotCount - 1;
+	}
+
+	//Returns the index of the vertex, adding it if it has not been seen yet. One probe sequence per call
+	uint32_t weld(const Vertex& vertex) { return weld(vertex, hashVertex(vertex)); }
+
+	uint32_t weld(const Vertex& vertex, uint64_t hash) {
+		uint32_t tag = static_cast<uint32_t>(hash >> 32);
+		for (size_t slot = static_cast<size_t>(hash) & mask;; slot = (slot + 1) & mask) {
+			Slot& entry = slots[slot];
+			if (entry.index == EMPTY_SLOT) {
+				uint32_t index = static_cast<uint32_t>(vertices.size());
+				entry = Slot{tag, index};
+				vertices.push_back(vertex);
+				if (vertices.size() * 2 > slots.size()) { grow(); }
+				return index;
+			}
+			if (entry.tag == tag && vertices[entry.index] == vertex) { return entry.index; }
+		}
+	}
+
+private:
+	struct Slot {
+		uint32_t tag;
+		uint32_t index;
+	};
+	static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+	std::vector<Vertex>& vertices;
+	std::vector<Slot> slots;
+	size_t mask;
+
+	//Keeps the load factor at or below 1/2 so linear probe chains stay short
+	void grow() {
+		std::vector<Slot> oldSlots(slots.size() * 2, Slot{0, EMPTY_SLOT});
+		oldSlots.swap(slots);
+		mask = slots.size() - 1;
+		for (const Slot& entry : oldSlots) {
+			if (entry.index == EMPTY_SLOT) { continue; }
+			size_t slot = static_cast<size_t>(hashVertex(vertices[entry.index])) & mask;
+			while (slots[slot].index != EMPTY_SLOT) { slot = (slot + 1) & mask; }
+			slots[slot] = entry;
+		}
+	}
+};
+
+//Welds count corners in parallel. getVertex(i) builds the vertex of corner i and must be safe to call from several threads.
+//Corners are split into hash partitions so equal vertices always land in the same partition and every partition is welded by one thread without locks.
+//The result is identical to welding the corners in order with a single VertexWelder
+template<typename GetVertex>
+inline void weldVerticesParallel(size_t count, GetVertex getVertex, unsigned int threadCount, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+	threadCount = std::max(1u, threadCount);
+	const size_t partitionCount = static_cast<size_t>(threadCount) * 4;
+	auto partitionOf = [partitionCount](uint64_t hash) { return static_cast<size_t>((hash >> 32) * partitionCount >> 32); };
+
+	auto runWorkers = [threadCount](size_t jobCount, auto job) {
+		std::atomic<size_t> nextJob{0};
+		auto work = [&]() { for (size_t i = nextJob++; i < jobCount; i = nextJob++) { job(i); } };
+		std::vector<std::thread> workers;
+		for (unsigned int i = 1; i < threadCount; i++) { workers.emplace_back(work); }
+		work();
+		for (auto& worker : workers) { worker.join(); }
+	};
+
+	//1. Hash every corner and count partition sizes per contiguous range of corners
+	const size_t rangeCount = threadCount;
+	std::vector<uint64_t> hashes(count);
+	std::vector<size_t> rangeCounts(rangeCount * partitionCount, 0);
+	runWorkers(rangeCount, [&](size_t range) {
+		size_t* counts = &rangeCounts[range * partitionCount];
+		for (size_t i = count * range / rangeCount; i < count * (range + 1) / rangeCount; i++) {
+			hashes[i] = hashVertex(getVertex(i));
+			counts[partitionOf(hashes[i])]++;
+		}
+	});
+
+	//2. Scatter corner ids into their partitions. Ranges are laid out in order, so every partition lists its corners in file order
+	std::vector<size_t> partitionBegin(partitionCount + 1, 0);
+	for (size_t partition = 0, offset = 0; partition < partitionCount; partition++) {
+		partitionBegin[partition] = offset;
+		for (size_t range = 0; range < rangeCount; range++) {
+			size_t rangeSize = rangeCounts[range * partitionCount + partition];
+			rangeCounts[range * partitionCount + partition] = offset;
+			offset += rangeSize;
+		}
+		partitionBegin[partition + 1] = offset;
+	}
+	std::vector<uint32_t> partitionCorners(count);
+	runWorkers(rangeCount, [&](size_t range) {
+		size_t* offsets = &rangeCounts[range * partitionCount];
+		for (size_t i = count * range / rangeCount; i < count * (range + 1) / rangeCount; i++) {
+			partitionCorners[offsets[partitionOf(hashes[i])]++] = static_cast<uint32_t>(i);
+		}
+	});
+
+	//3. Weld each partition on its own. indices temporarily holds partition-local vertex ids
+	std::vector<std::vector<Vertex>> partitionVertices(partitionCount);
+	std::vector<std::vector<uint32_t>> partitionFirstCorners(partitionCount);
+	size_t indexBase = indices.size();
+	indices.resize(indexBase + count);
+	runWorkers(partitionCount, [&](size_t partition) {
+		size_t partitionSize = partitionBegin[partition + 1] - partitionBegin[partition];
+		VertexWelder welder(partitionVertices[partition], partitionSize / 4);
+		for (size_t i = partitionBegin[partition]; i < partitionBegin[partition + 1]; i++) {
+			uint32_t corner = partitionCorners[i];
+			size_t before = partitionVertices[partition].size();
+			indices[indexBase + corner] = welder.weld(getVertex(corner), hashes[corner]);
+			if (partitionVertices[partition].size() != before) { partitionFirstCorners[partition].push_back(corner); }
+		}
+	});
+	hashes = std::vector<uint64_t>();
+
+	//4. Number the unique vertices by the corner that first used them. Each partition is already sorted, so this is a k-way merge
+	std::vector<std::vector<uint32_t>> partitionToGlobal(partitionCount);
+	std::vector<size_t> cursors(partitionCount, 0);
+	size_t vertexBase = vertices.size(), uniqueCount = 0;
+	for (size_t partition = 0; partition < partitionCount; partition++) {
+		partitionToGlobal[partition].resize(partitionVertices[partition].size());
+		uniqueCount += partitionVertices[partition].size();
+	}
+	vertices.resize(vertexBase + uniqueCount);
+
+	using Head = std::pair<uint32_t, uint32_t>; //First corner, partition
+	std::vector<Head> heap;
+	for (size_t partition = 0; partition < partitionCount; partition++) {
+		if (!partitionFirstCorners[partition].empty()) { heap.push_back({partitionFirstCorners[partition][0], static_cast<uint32_t>(partition)}); }
+	}
+	std::make_heap(heap.begin(), heap.end(), std::greater<Head>());
+	for (size_t next = vertexBase; !heap.empty(); next++) {
+		std::pop_heap(heap.begin(), heap.end(), std::greater<Head>());
+		uint32_t partition = heap.back().second;
+		size_t local = cursors[partition]++;
+		partitionToGlobal[partition][local] = static_cast<uint32_t>(next);
+		vertices[next] = partitionVertices[partition][local];
+		if (cursors[partition] < partitionFirstCorners[partition].size()) {
+			heap.back().first = partitionFirstCorners[partition][cursors[partition]];
+			std::push_heap(heap.begin(), heap.end(), std::greater<Head>());
+		} else {
+			heap.pop_back();
+		}
+	}
+
+	//5. Rewrite the partition-local ids to global ones
+	runWorkers(partitionCount, [&](size_t partition) {
+		const std::vector<uint32_t>& toGlobal = partitionToGlobal[partition];
+		for (size_t i = partitionBegin[partition]; i < partitionBegin[partition + 1]; i++) {
+			uint32_t corner = partitionCorners[i];
+			indices[indexBase + corner] = toGlobal[indices[indexBase + corner]];
+		}
+	});
+}
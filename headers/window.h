@@ -1,8 +1,27 @@
 void initializeWindow() {
+	if (HEADLESS) { return; }
 	glfwInit();
 
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API); //Dont create OpenGL context
 	glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE); //Toggle resizable window
 	
 	window = glfwCreateWindow(WIDTH, HEIGHT, "Vulkan", nullptr, nullptr);
+	glfwSetWindowUserPointer(window, this);
+	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+}
+
+static void framebufferResizeCallback(GLFWwindow* window, int, int) {
+	auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window));
+	app->framebufferResized = true;
+	app->noteResize();
+}
+
+//Start of the resize-to-present latency, the first resize noticed since the last frame presented at a new size
+void noteResize() {
+	if (!resizeStartTime) { resizeStartTime = std::chrono::high_resolution_clock::now(); }
+}
+
+//For the benchmark loops, which also run headless
+void pollWindowEvents() {
+	if (!HEADLESS) { glfwPollEvents(); }
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 #include <glm/gtx/hash.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -15,6 +16,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <iomanip>
 #include <stdexcept>
 #include <algorithm>
 #include <chrono>
@@ -27,8 +29,48 @@
 #include <optional>
 #include <set>
 #include <unordered_map>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <filesystem>
+#include <deque>
+#include <memory>
+#include <tuple>
+#include <mutex>
+#include <condition_variable>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include "headers/structs.h"
+#include "headers/mappedFile.h"
+#include "headers/hash.h"
+#include "headers/objParser.h"
+#include "headers/vertexWelder.h"
+#include "headers/meshOptimizer.h"
+#include "headers/vertexQuantization.h"
+#include "headers/indexRanges.h"
+#include "headers/meshletBuilder.h"
+#include "headers/simplifier.h"
+#include "headers/meshCache.h"
+#include "headers/pipelineCacheFile.h"
+#include "headers/pipelineKey.h"
+#include "headers/memoryAllocator.h"
+#include "headers/stagingRing.h"
+#include "headers/assetLoader.h"
+#include "headers/pipelineLibrary.h"
+#include "headers/deletionQueue.h"
+#include "headers/benchmarkStatistics.h"
+#include "headers/gpuProfiler.h"
+#include "headers/trace.h"
 
 #ifdef NDEBUG
 const bool enableValidationLayers = false;
@@ -38,20 +80,67 @@ const bool enableValidationLayers = true;
 
 const VkPresentModeKHR PRESENTMODE = VK_PRESENT_MODE_IMMEDIATE_KHR;
 
+const VkDeviceSize MEMORY_BLOCK_SIZE = 64 * 1024 * 1024; //Device memory is reserved in blocks of this size and sub-allocated, larger resources get their own
+const VkDeviceSize STAGING_RING_SIZE = 8 * 1024 * 1024; //Shared by all uploads, larger uploads are split into chunks of a quarter of this
+const bool USE_TRANSFER_QUEUE = true; //Uploads on a dedicated transfer queue family when the device has one, the graphics queue otherwise
+const bool BATCH_UPLOADS = true; //Record all uploads into one command buffer per batch instead of submitting and waiting for each operation
+const VkDeviceSize STAGING_ALIGNMENT = 16; //Offset alignment of every chunk, covers the texel size of any color format
+
 const uint32_t WIDTH = 800;
 const uint32_t HEIGHT = 600;
-const int MAX_FRAMES_IN_FLIGHT = 2;
+const bool HEADLESS = false; //No window, surface or swapchain, renders HEADLESS_FRAMES frames into offscreen images at WIDTH x HEIGHT, prints the throughput and exits
+const uint32_t HEADLESS_FRAMES = 1000;
+const bool RUN_FRAME_BENCHMARK = false; //Times every drawFrame() stage after a warmup, writes the statistics to FRAME_BENCHMARK_OUTPUT .json and .csv and exits
+const uint32_t FRAME_BENCHMARK_WARMUP_FRAMES = 100;
+const uint32_t FRAME_BENCHMARK_FRAMES = 1000; //Measured frames, 0 runs for FRAME_BENCHMARK_SECONDS instead
+const double FRAME_BENCHMARK_SECONDS = 10.0;
+const uint32_t FRAME_BENCHMARK_HISTOGRAM_BINS = 20;
+const std::string FRAME_BENCHMARK_OUTPUT = "frame_benchmark";
+const bool GPU_PROFILING = false; //Timestamp queries around frames, render passes, uploads and mipmaps, read back a few frames later and added to the frame benchmark report
+const bool GPU_PROFILE_DRAWS = true; //Also one scope per draw call, as long as the command buffer's block has queries left
+const uint32_t GPU_PROFILER_BLOCKS = 32; //Command buffers that can be profiled at once, recorded or waiting for readback
+const uint32_t GPU_PROFILER_QUERIES_PER_BLOCK = 256; //Two per scope
+const bool TRACING = false; //Records CPU scopes of every thread, and the GPU_PROFILING scopes on the same clock, into TRACE_OUTPUT for chrome://tracing or Perfetto
+const std::string TRACE_OUTPUT = "trace.json";
+const size_t TRACE_EVENTS_PER_THREAD = 1 << 18; //Later events are dropped
+const uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+const uint32_t FRAMES_IN_FLIGHT = 2; //How far the CPU may run ahead of the GPU, 1 to MAX_FRAMES_IN_FLIGHT. setFramesInFlight() changes it at runtime
+const bool RUN_FRAMES_IN_FLIGHT_BENCHMARK = false; //Renders with every depth in FRAMES_IN_FLIGHT_BENCHMARK_DEPTHS, prints the CPU wait and frame times and exits
+const std::vector<uint32_t> FRAMES_IN_FLIGHT_BENCHMARK_DEPTHS = {1, 2, 3};
+const uint32_t FRAMES_IN_FLIGHT_BENCHMARK_FRAMES = 300; //Measured frames per depth, after FRAMES_IN_FLIGHT_BENCHMARK_FRAMES / 10 warmup frames
+static_assert(FRAMES_IN_FLIGHT >= 1 && FRAMES_IN_FLIGHT <= MAX_FRAMES_IN_FLIGHT, "FRAMES_IN_FLIGHT out of range");
+const bool USE_TIMELINE_SEMAPHORES = true; //Vulkan 1.2 timeline semaphores for frame and upload sync, per frame and per batch fences if the device has none
 
 const std::string MODEL_PATH = "models/viking_room.obj";
 const std::string TEXTURE_PATH = "textures/viking_room.png";
-
-namespace std {
-	template<> struct hash<Vertex> {
-		size_t operator()(Vertex const& vertex) const {
-			return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^ (hash<glm::vec2>()(vertex.texCoord) << 1);
-		}
-	};
-}
+const bool ASYNC_ASSET_LOADING = true; //Decode the model and texture on worker threads and draw a placeholder until they are resident, instead of loading before the first frame
+const unsigned int ASSET_LOADER_THREADS = 2; //One per asset, the parallel OBJ loader starts its own threads on top
+
+const ModelLoader MODEL_LOADER = ModelLoader::Parallel; //Mapped keeps peak memory close to the output mesh, at single threaded speed
+const unsigned int MODEL_LOADER_THREADS = 0; //0 uses every hardware thread
+const bool USE_MESH_CACHE = true; //Binary cache of the optimized mesh next to the model, skips OBJ parsing and optimizeMesh() on warm starts
+const bool VERIFY_MESH_CACHE_SOURCE = false; //Also hash the whole OBJ on a cache hit, catches edits that keep the size and timestamp
+const bool OPTIMIZE_MESH = true; //Reorder indices and vertices for the post-transform cache, overdraw and vertex fetch
+const float OVERDRAW_THRESHOLD = 1.05f; //How much vertex cache efficiency the overdraw pass may give up
+const VertexFormat VERTEX_FORMAT = VertexFormat::Full; //Quantized halves vertex memory, 16-bit positions relative to the mesh bounds, see the error report at load
+const bool ALLOW_16BIT_INDICES = true; //uint16 index buffer, split into several draws for meshes over 65536 vertices
+const RenderPath RENDER_PATH = RenderPath::Indexed;
+const uint32_t INSTANCE_COUNT = 1; //Copies of the model on a grid, all drawn by one instanced call. Disables meshlet culling, which works on a single model
+const bool RUN_INSTANCE_BENCHMARK = false; //Renders every count in INSTANCE_BENCHMARK_COUNTS instanced and with one draw per instance, prints the timings and exits
+const std::vector<uint32_t> INSTANCE_BENCHMARK_COUNTS = {1000, 10000, 100000};
+const uint32_t INSTANCE_BENCHMARK_FRAMES = 300; //Measured frames per run, after INSTANCE_BENCHMARK_FRAMES / 10 warmup frames
+const bool USE_INSTANCING = INSTANCE_COUNT > 1 || RUN_INSTANCE_BENCHMARK;
+const bool GENERATE_LODS = true; //Simplified copies of the index buffer drawn when the camera is far away
+const std::vector<float> LOD_TARGET_RATIOS = {0.5f, 0.25f, 0.125f}; //Triangle count of each level relative to the full mesh
+const float LOD_ERROR_THRESHOLD = 1.0f; //Largest geometric error in pixels a coarser level may show
+const float LOD_HYSTERESIS = 0.8f; //Switching to a coarser level needs the error under this fraction of the threshold, so the level does not flicker at the boundary
+
+const bool USE_PIPELINE_CACHE = true; //Keep compiled pipelines on disk between runs
+const std::string PIPELINE_CACHE_PATH = "pipeline.cache";
+const double PIPELINE_CACHE_SAVE_INTERVAL = 60.0; //Seconds between saves while running, it is also saved on shutdown
+const VkCullModeFlags SCENE_CULL_MODE = VK_CULL_MODE_BACK_BIT; //Scene pipeline state. If it differs from the fallback pipeline it is compiled in the background
+const bool SCENE_ALPHA_BLEND = false;
+const unsigned int PIPELINE_COMPILER_THREADS = 2;
 
 const std::vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
 const std::vector<const char*> validationLayers = { "VK_LAYER_KHRONOS_validation" };
@@ -59,63 +148,134 @@ const std::vector<const char*> validationLayers = { "VK_LAYER_KHRONOS_validation
 class HelloTriangleApplication {
 public:
 	void run() {
+		startupTime = std::chrono::high_resolution_clock::now();
+		startTracing();
 		initializeWindow();
 		initializeVulkan();
 
-		while (!glfwWindowShouldClose(window)) { //Main loop
+		if (RUN_INSTANCE_BENCHMARK) { runInstanceBenchmark(); }
+		if (RUN_FRAMES_IN_FLIGHT_BENCHMARK) { runFramesInFlightBenchmark(); }
+		if (RUN_FRAME_BENCHMARK) { runFrameBenchmark(); }
+		bool benchmark = RUN_INSTANCE_BENCHMARK || RUN_FRAMES_IN_FLIGHT_BENCHMARK || RUN_FRAME_BENCHMARK;
+		if (HEADLESS && !benchmark) { runHeadless(); }
+		while (!HEADLESS && !benchmark && !glfwWindowShouldClose(window)) { //Main loop
 			glfwPollEvents();
 			drawFrame();
 		}
 
 		cleanup();
+		writeTrace();
 	}
 
 private:
-	GLFWwindow* window;
+	GLFWwindow* window = nullptr;
 
 	VkInstance instance;
 	VkDebugUtilsMessengerEXT debugMessenger;
-	VkSurfaceKHR surface;
+	VkSurfaceKHR surface = VK_NULL_HANDLE;
 
 	VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
 	VkDevice device;
+	std::unique_ptr<MemoryAllocator> memoryAllocator;
 
 	VkQueue graphicsQueue;
 	VkQueue presentQueue;
+	VkQueue transferQueue; //Same as graphicsQueue without a separate transfer family
 
-	VkSwapchainKHR swapChain;
+	VkSwapchainKHR swapChain = VK_NULL_HANDLE;
 	std::vector<VkImage> swapChainImages;
 	VkFormat swapChainImageFormat;
 	VkExtent2D swapChainExtent;
 	std::vector<VkImageView> swapChainImageViews;
 	std::vector<VkFramebuffer> swapChainFramebuffers;
+	std::vector<MemoryAllocation> offscreenImagesMemory; //HEADLESS, swapChainImages are offscreen color targets
 
 	VkRenderPass renderPass;
 	VkDescriptorSetLayout descriptorSetLayout;
 	VkPipelineLayout pipelineLayout;
-	VkPipeline graphicsPipeline;
+	VkPipeline graphicsPipeline; //Fallback for permutations that are still compiling
+	VkPipeline scenePipeline = VK_NULL_HANDLE; //Bound for the scene, graphicsPipeline until the SCENE_ state permutation is ready
+	PipelineKey scenePermutation{}; //Built and checked once by createPipelineLibrary()
+	std::unique_ptr<PipelineLibrary> pipelineLibrary;
+	VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+	bool pipelineCacheWarm = false; //Loaded from disk
+	uint64_t savedPipelineCacheHash = 0; //Of the data last written, saves are skipped while the driver's data is unchanged
+	std::chrono::high_resolution_clock::time_point lastPipelineCacheSave;
 
 	VkCommandPool commandPool;
+	VkCommandPool transferCommandPool;
+
+	VkBuffer stagingBuffer;
+	MemoryAllocation stagingBufferMemory;
+	StagingRing stagingRing;
+	std::deque<StagingSubmission> stagingSubmissions; //In flight, oldest first
+	std::vector<StagingSubmission> idleStagingSubmissions;
+	std::optional<StagingSubmission> uploadBatch; //Recording, not submitted yet
+	VkSemaphore uploadTimeline = VK_NULL_HANDLE; //Reaches the ticket of each batch when it completes
+	UploadTicket nextUploadTicket = 1;
+	UploadTicket completedUploadTicket = 0;
+	uint32_t uploadSubmits = 0;
+	uint32_t uploadStalls = 0; //Times the CPU waited for an upload
 
 	VkImage depthImage;
-	VkDeviceMemory depthImageMemory;
+	MemoryAllocation depthImageMemory;
 	VkImageView depthImageView;
+	VkExtent2D depthExtent{0, 0}; //Can be larger than swapChainExtent after a resize
 
 	uint32_t mipLevels;
-	VkImage textureImage;
-	VkDeviceMemory textureImageMemory;
-	VkImageView textureImageView;
+	VkImage textureImage = VK_NULL_HANDLE;
+	MemoryAllocation textureImageMemory;
+	VkImageView textureImageView = VK_NULL_HANDLE;
 	VkSampler textureSampler;
 
 	std::vector<Vertex> vertices;
 	std::vector<uint32_t> indices;
-	VkBuffer vertexBuffer;
-	VkDeviceMemory vertexBufferMemory;
-	VkBuffer indexBuffer;
-	VkDeviceMemory indexBufferMemory;
+	VertexQuantization vertexQuantization{glm::vec3(0.0f), glm::vec3(1.0f)};
+	VkBuffer vertexBuffer = VK_NULL_HANDLE;
+	MemoryAllocation vertexBufferMemory;
+	VkBuffer indexBuffer = VK_NULL_HANDLE;
+	MemoryAllocation indexBufferMemory;
+	VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+	std::vector<IndexRange> indexRanges;
+
+	VkBuffer instanceBuffer = VK_NULL_HANDLE;
+	MemoryAllocation instanceBufferMemory;
+	uint32_t instanceCount = INSTANCE_COUNT;
+	bool drawInstancesSeparately = false; //One vkCmdDrawIndexed per instance, the baseline of the instancing benchmark
+	float instanceViewScale = 1.0f; //Pulls the camera back so the whole grid is in view
+	double lastSubmitTime = 0.0; //Milliseconds spent recording and submitting the last frame
+
+	std::unique_ptr<AssetLoader> assetLoader; //Only while assets are loading
+	std::optional<UploadTicket> modelUpload; //Submitted, waiting to be published
+	std::optional<UploadTicket> textureUpload;
+	bool modelResident = false; //The placeholder cube is drawn until this is set
+	bool textureResident = false;
+	std::vector<bool> descriptorSetsStale; //Still point at the placeholder texture, rewritten once their frame is idle
+	VkBuffer placeholderVertexBuffer; //All placeholder handles are valid while placeholderImage is set
+	MemoryAllocation placeholderVertexBufferMemory;
+	VkBuffer placeholderIndexBuffer;
+	MemoryAllocation placeholderIndexBufferMemory;
+	uint32_t placeholderIndexCount = 0;
+	VertexQuantization placeholderQuantization{glm::vec3(0.0f), glm::vec3(1.0f)};
+	VkImage placeholderImage = VK_NULL_HANDLE;
+	MemoryAllocation placeholderImageMemory;
+	VkImageView placeholderImageView;
+	std::chrono::high_resolution_clock::time_point startupTime;
+	bool firstFramePresented = false;
+
+	std::vector<Meshlet> meshlets;
+	std::vector<MeshletBounds> meshletBounds;
+	std::vector<uint32_t> visibleMeshlets;
+	MeshletCullStats meshletCullStats{};
+	std::vector<MeshLod> lods;
+	glm::vec3 lodBoundsCenter{0.0f};
+	float lodBoundsRadius = 0.0f;
+	uint32_t currentLod = 0;
+	uint64_t lodSwitches = 0;
+	UniformBufferObject frameUniforms{}; //Matrices of the frame being recorded, used for CPU culling
 
 	std::vector<VkBuffer> uniformBuffers;
-	std::vector<VkDeviceMemory> uniformBuffersMemory;
+	std::vector<MemoryAllocation> uniformBuffersMemory;
 	std::vector<void*> uniformBuffersMapped;
 
 	VkDescriptorPool descriptorPool;
@@ -125,41 +285,75 @@ private:
 
 	std::vector<VkSemaphore> imageAvailableSemaphores;
 	std::vector<VkSemaphore> renderFinishedSemaphores;
-	std::vector<VkFence> inFlightFences;
+	std::vector<VkFence> inFlightFences; //Not created with timeline semaphores
+	bool useTimelineSemaphores = false;
+	bool hostQueryReset = false; //vkResetQueryPool, lets the profiler time transfer-only queues
+	VkSemaphore frameTimeline = VK_NULL_HANDLE; //Reaches the frame number of each frame when the GPU finishes it
+	uint32_t framesInFlight = FRAMES_IN_FLIGHT;
+	double lastFrameWaitTime = 0.0; //Milliseconds the CPU blocked on the last frame slot
+	FrameTiming lastFrameTiming; //Of the last submitted frame
+	std::unique_ptr<GpuProfiler> gpuProfiler; //Only with GPU_PROFILING and timestamp support
+	std::vector<uint32_t> queueTimestampBits; //Per queue family, 0 if it cannot be profiled
+	std::vector<GpuTiming> lastGpuTimings; //Read back during the last frame, from frames and uploads submitted a few frames earlier
+	int64_t gpuClockOffset = 0; //Trace clock minus GPU timestamp, in nanoseconds
+	uint64_t frameNumber = 0; //Submitted frames
+	uint64_t fenceCompletedFrame = 0;
+	DeletionQueue deletionQueue;
 	uint32_t currentFrame = 0;
 	
 	bool framebufferResized = false;
+	std::optional<std::chrono::high_resolution_clock::time_point> resizeStartTime; //Resize noticed, no frame presented at the new size yet
+	bool swapchainRecreatedForResize = false;
+	SwapchainStats swapchainStats;
 
 	QueueFamilyIndices queueFamilyIndices;
 
+	#include "headers/assets.h"
 	#include "headers/buffer.h"
 	#include "headers/cleanup.h"
 	#include "headers/commands.h"
 	#include "headers/debug.h"
+	#include "headers/deletion.h"
 	#include "headers/depth.h"
 	#include "headers/descriptors.h"
+	#include "headers/deviceMemory.h"
 	#include "headers/device.h"
 	#include "headers/drawFrame.h"
+	#include "headers/frameBenchmark.h"
 	#include "headers/frameBuffers.h"
+	#include "headers/framesInFlight.h"
+	#include "headers/gpuProfiling.h"
 	#include "headers/graphicsPipeline.h"
 	#include "headers/image.h"
 	#include "headers/instance.h"
+	#include "headers/instancing.h"
 	#include "headers/loadModel.h"
+	#include "headers/lod.h"
+	#include "headers/meshlets.h"
 	#include "headers/mipmaps.h"
+	#include "headers/offscreen.h"
+	#include "headers/optimizeMesh.h"
+	#include "headers/pipelineCache.h"
+	#include "headers/pipelines.h"
 	#include "headers/renderPass.h"
+	#include "headers/staging.h"
 	#include "headers/swapChain.h"
 	#include "headers/syncObjects.h"
 	#include "headers/textureImage.h"
 	#include "headers/textureSampler.h"
+	#include "headers/tracing.h"
 	#include "headers/window.h"
 
 	void initializeVulkan() {
+		TraceScope traceScope("initializeVulkan", "init");
 		createInstance();
 		setupDebugMessenger();
 		createSurface();
 
 		pickPhysicalDevice();
-		createDevice();
+		TRACE_STEP(createDevice());
+		createMemoryAllocator();
+		createGpuProfiler();
 
 		createSwapchain();
 		createImageViews();
@@ -167,27 +361,32 @@ private:
 
 		createDescriptorSetLayout();
 
-		createGraphicsPipeline();
+		createPipelineCache();
+		TRACE_STEP(createGraphicsPipeline());
+		createPipelineLibrary();
 
 		createCommandPool();
+		calibrateGpuClock();
 		createCommandBuffers();
+		createStagingRing();
 
 		createDepthResources();
 		createFramebuffers();
 
-		loadModel();
-		createTextureImage();
-		createTextureImageView();
 		createTextureSampler();
+		createPlaceholderAssets();
+		TRACE_STEP(startAssetLoading()); //Model and texture, see assets.h
+		if (!ASYNC_ASSET_LOADING) { TRACE_STEP(waitForAssets()); }
 
-		createVertexBuffer();
-		createIndexBuffer();
 		createUniformBuffer();
 
 		createDescriptorPool();
 		createDescriptorSets();
 
 		createSyncObjects();
+		TRACE_STEP(flushUploads()); //Ordered before the first frame on the same queue, no need to wait for it
+		reportUploadStats("Startup");
+		reportMemoryStats();
 	}
 
 	bool hasStencilComponent(VkFormat format) { return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;	}
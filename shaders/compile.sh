@@ -1,2 +1,5 @@
 glslc shader.vert -o vert.spv
+glslc shader_quantized.vert -o vert_quantized.spv
+glslc shader_instanced.vert -o vert_instanced.spv
+glslc shader_quantized_instanced.vert -o vert_quantized_instanced.spv
 glslc shader.frag -o frag.spv
\ No newline at end of file
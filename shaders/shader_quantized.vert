@@ -0,0 +1,24 @@
+#version 450
+
+//Vertex shader for VertexFormat::Quantized: 16-bit unorm positions relative to the mesh bounds, half float UVs, no color
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+    vec4 positionOffset;
+    vec4 positionScale;
+} ubo;
+
+layout(location = 0) in vec4 inPosition; //R16G16B16A16_UNORM, already in [0, 1]
+layout(location = 2) in vec2 inTexCoord; //R16G16_SFLOAT
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+
+void main() {
+    vec3 position = ubo.positionOffset.xyz + inPosition.xyz * ubo.positionScale.xyz;
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(position, 1.0);
+    fragColor = vec3(1.0);
+    fragTexCoord = inTexCoord;
+}
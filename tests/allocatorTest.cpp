@@ -0,0 +1,289 @@
+//MemoryAllocator against a fake MemoryBackend, no device needed. Checks alignment, bufferImageGranularity separation, the dedicated block threshold,
+//free and coalescing, mapping and the stats. Exits with 1 if any check fails
+//Usage: ./allocatorTest [random operations]
+
+#include <vulkan/vulkan.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstdint>
+#include <limits>
+#include <array>
+#include <unordered_map>
+#include <map>
+#include <memory>
+#include <functional>
+#include <random>
+
+#include "../headers/memoryAllocator.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if (!(condition)) { std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << std::endl; failures++; } } while (0)
+
+//Hands out numbered handles, host memory for mapping, and fails once budget bytes are allocated
+struct FakeDevice {
+	uint64_t budget = std::numeric_limits<uint64_t>::max();
+	uint64_t allocatedBytes = 0;
+	uint64_t nextHandle = 1;
+	std::map<uint64_t, std::vector<char>> memories;
+	size_t frees = 0;
+	size_t maps = 0;
+
+	static uint64_t id(VkDeviceMemory memory) { return (uint64_t)(uintptr_t)memory; }
+
+	MemoryBackend backend() {
+		MemoryBackend backend;
+		backend.allocate = [this](uint32_t, VkDeviceSize size) {
+			if (allocatedBytes + size > budget) { return (VkDeviceMemory)VK_NULL_HANDLE; }
+			allocatedBytes += size;
+			uint64_t handle = nextHandle++;
+			memories[handle].resize(static_cast<size_t>(size));
+			return (VkDeviceMemory)(uintptr_t)handle;
+		};
+		backend.free = [this](VkDeviceMemory memory) {
+			auto found = memories.find(id(memory));
+			if (found == memories.end()) { throw std::runtime_error("fake device freed unknown memory!"); }
+			allocatedBytes -= found->second.size();
+			memories.erase(found);
+			frees++;
+		};
+		backend.map = [this](VkDeviceMemory memory) {
+			maps++;
+			return static_cast<void*>(memories.at(id(memory)).data());
+		};
+		return backend;
+	}
+};
+
+const VkDeviceSize BLOCK_SIZE = 1 << 20;
+const VkDeviceSize GRANULARITY = 1024;
+const std::vector<VkMemoryPropertyFlags> MEMORY_TYPES = {VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+
+VkMemoryRequirements requirements(VkDeviceSize size, VkDeviceSize alignment) {
+	VkMemoryRequirements result{};
+		result.size = size;
+		result.alignment = alignment;
+		result.memoryTypeBits = 3;
+	return result;
+}
+
+bool overlaps(const MemoryAllocation& a, const MemoryAllocation& b) {
+	return a.memory == b.memory && a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+}
+
+void testAlignment() {
+	FakeDevice device;
+	MemoryAllocator allocator(device.backend(), MEMORY_TYPES, BLOCK_SIZE, 1);
+	std::vector<MemoryAllocation> allocations;
+	const VkDeviceSize alignments[] = {1, 4, 16, 64, 256, 4096};
+	for (int i = 0; i < 60; i++) {
+		VkDeviceSize alignment = alignments[i % 6];
+		allocations.push_back(allocator.allocate(requirements(100 + i * 37, alignment), 0, false));
+		CHECK(allocations.back().offset % alignment == 0);
+		CHECK(allocations.back().size == 100 + static_cast<VkDeviceSize>(i) * 37);
+	}
+	for (size_t i = 0; i < allocations.size(); i++) {
+		for (size_t j = i + 1; j < allocations.size(); j++) { CHECK(!overlaps(allocations[i], allocations[j])); }
+	}
+	CHECK(allocator.getStats().blockCount == 1);
+	for (auto& allocation : allocations) { allocator.free(allocation); }
+}
+
+//Optimal images get whole granularity pages, so no buffer may share a page with one
+void testGranularity() {
+	FakeDevice device;
+	MemoryAllocator allocator(device.backend(), MEMORY_TYPES, BLOCK_SIZE, GRANULARITY);
+	std::vector<MemoryAllocation> buffers, images;
+	for (int i = 0; i < 20; i++) {
+		buffers.push_back(allocator.allocate(requirements(100 + i * 13, 16), 0, false));
+		images.push_back(allocator.allocate(requirements(300 + i * 29, 256), 0, true));
+	}
+	for (const auto& image : images) {
+		CHECK(image.offset % GRANULARITY == 0);
+		CHECK(image.size % GRANULARITY == 0);
+		CHECK(image.size >= image.requestedSize);
+		for (const auto& buffer : buffers) {
+			if (buffer.memory != image.memory) { continue; }
+			VkDeviceSize firstPage = buffer.offset / GRANULARITY, lastPage = (buffer.offset + buffer.size - 1) / GRANULARITY;
+			VkDeviceSize imageFirstPage = image.offset / GRANULARITY, imageLastPage = (image.offset + image.size - 1) / GRANULARITY;
+			CHECK(lastPage < imageFirstPage || firstPage > imageLastPage);
+		}
+	}
+
+	uint64_t padding = 0;
+	for (const auto& image : images) { padding += image.size - image.requestedSize; }
+	CHECK(allocator.getStats().wastedBytes == padding);
+	for (auto& allocation : buffers) { allocator.free(allocation); }
+	for (auto& allocation : images) { allocator.free(allocation); }
+	CHECK(allocator.getStats().wastedBytes == 0);
+}
+
+//Anything over half a block gets its own block, released with the resource
+void testDedicatedThreshold() {
+	FakeDevice device;
+	MemoryAllocator allocator(device.backend(), MEMORY_TYPES, BLOCK_SIZE, 1);
+	MemoryAllocation half = allocator.allocate(requirements(BLOCK_SIZE / 2, 16), 0, false);
+	CHECK(allocator.getStats().dedicatedBlockCount == 0);
+	CHECK(device.memories.at(FakeDevice::id(half.memory)).size() == BLOCK_SIZE);
+
+	MemoryAllocation large = allocator.allocate(requirements(BLOCK_SIZE / 2 + 1, 16), 0, false);
+	MemoryAllocatorStats stats = allocator.getStats();
+	CHECK(stats.dedicatedBlockCount == 1);
+	CHECK(stats.blockCount == 2);
+	CHECK(large.offset == 0);
+	CHECK(device.memories.at(FakeDevice::id(large.memory)).size() == BLOCK_SIZE / 2 + 1);
+
+	allocator.free(large);
+	CHECK(large.memory == VK_NULL_HANDLE);
+	CHECK(device.frees == 1);
+	CHECK(allocator.getStats().dedicatedBlockCount == 0);
+	CHECK(allocator.getStats().blockCount == 1);
+
+	//Shared blocks stay around when empty
+	allocator.free(half);
+	CHECK(device.frees == 1);
+	CHECK(allocator.getStats().blockCount == 1);
+}
+
+//Without room for a whole block the allocator falls back to a block that only fits the resource
+void testOutOfMemoryFallback() {
+	FakeDevice device;
+	device.budget = BLOCK_SIZE / 2;
+	MemoryAllocator allocator(device.backend(), MEMORY_TYPES, BLOCK_SIZE, 1);
+	MemoryAllocation allocation = allocator.allocate(requirements(4096, 16), 0, false);
+	CHECK(allocator.getStats().dedicatedBlockCount == 1);
+	CHECK(device.allocatedBytes == 4096);
+
+	bool threw = false;
+	try { allocator.allocate(requirements(BLOCK_SIZE / 2, 16), 0, false); } catch (const std::runtime_error&) { threw = true; }
+	CHECK(threw);
+	allocator.free(allocation);
+	CHECK(device.allocatedBytes == 0);
+}
+
+void testFreeAndCoalesce() {
+	FakeDevice device;
+	MemoryAllocator allocator(device.backend(), MEMORY_TYPES, BLOCK_SIZE, 1);
+	std::array<MemoryAllocation, 5> allocations;
+	for (auto& allocation : allocations) { allocation = allocator.allocate(requirements(BLOCK_SIZE / 8, 256), 0, false); }
+	CHECK(allocator.getStats().blockCount == 1);
+
+	//Free every other range, then the ones in between, so each free merges with both neighbours
+	allocator.free(allocations[1]);
+	allocator.free(allocations[3]);
+	MemoryAllocatorStats stats = allocator.getStats();
+	CHECK(stats.allocationCount == 3);
+	CHECK(stats.freeRangeCount == 3);
+	CHECK(stats.largestFreeRange == BLOCK_SIZE - 5 * (BLOCK_SIZE / 8));
+	CHECK(stats.fragmentation > 0.0);
+
+	allocator.free(allocations[2]);
+	CHECK(allocator.getStats().freeRangeCount == 2);
+	CHECK(allocator.getStats().largestFreeRange == 3 * (BLOCK_SIZE / 8));
+	allocator.free(allocations[0]);
+	allocator.free(allocations[4]);
+	stats = allocator.getStats();
+	CHECK(stats.allocationCount == 0);
+	CHECK(stats.usedBytes == 0);
+	CHECK(stats.freeRangeCount == 1);
+	CHECK(stats.largestFreeRange == BLOCK_SIZE);
+	CHECK(stats.fragmentation == 0.0);
+
+	//The whole block is one range again
+	MemoryAllocation whole = allocator.allocate(requirements(BLOCK_SIZE / 2, 1), 0, false);
+	MemoryAllocation rest = allocator.allocate(requirements(BLOCK_SIZE / 2, 1), 0, false);
+	CHECK(whole.memory == rest.memory);
+	CHECK(allocator.getStats().deviceAllocations == 1);
+	allocator.free(whole);
+	allocator.free(rest);
+}
+
+void testMappingAndStats() {
+	FakeDevice device;
+	MemoryAllocation hostVisible, deviceLocal;
+	{
+		MemoryAllocator allocator(device.backend(), MEMORY_TYPES, BLOCK_SIZE, 1);
+		deviceLocal = allocator.allocate(requirements(1000, 16), 0, false);
+		hostVisible = allocator.allocate(requirements(1000, 16), 1, false);
+		MemoryAllocation second = allocator.allocate(requirements(1000, 16), 1, false);
+		CHECK(deviceLocal.mapped == nullptr);
+		CHECK(deviceLocal.memory != hostVisible.memory);
+		CHECK(hostVisible.memory == second.memory);
+		CHECK(device.maps == 1);
+		char* base = device.memories.at(FakeDevice::id(hostVisible.memory)).data();
+		CHECK(hostVisible.mapped == base + hostVisible.offset);
+		CHECK(second.mapped == base + second.offset);
+
+		MemoryAllocatorStats stats = allocator.getStats();
+		CHECK(stats.blockCount == 2);
+		CHECK(stats.allocationCount == 3);
+		CHECK(stats.deviceAllocations == 2);
+		CHECK(stats.reservedBytes == 2 * BLOCK_SIZE);
+		CHECK(stats.usedBytes == 3000);
+		CHECK(stats.wastedBytes == 0);
+		allocator.free(second);
+	}
+	//The destructor releases the blocks that are left
+	CHECK(device.memories.empty());
+}
+
+//Random allocations and frees, checked for overlap against each other and for a fully coalesced allocator at the end
+void testRandom(int operations) {
+	FakeDevice device;
+	MemoryAllocator allocator(device.backend(), MEMORY_TYPES, BLOCK_SIZE, GRANULARITY);
+	std::mt19937 random(1234);
+	std::vector<MemoryAllocation> live;
+	for (int i = 0; i < operations; i++) {
+		if (!live.empty() && random() % 3 == 0) {
+			size_t index = random() % live.size();
+			allocator.free(live[index]);
+			live[index] = live.back();
+			live.pop_back();
+			continue;
+		}
+		VkDeviceSize size = 1 + random() % (BLOCK_SIZE / 16);
+		VkDeviceSize alignment = VkDeviceSize(1) << (random() % 9);
+		MemoryAllocation allocation = allocator.allocate(requirements(size, alignment), random() % 2, random() % 2 == 0);
+		CHECK(allocation.offset % alignment == 0);
+		for (const auto& other : live) { CHECK(!overlaps(allocation, other)); }
+		live.push_back(allocation);
+	}
+	for (auto& allocation : live) { allocator.free(allocation); }
+
+	MemoryAllocatorStats stats = allocator.getStats();
+	CHECK(stats.allocationCount == 0);
+	CHECK(stats.usedBytes == 0);
+	CHECK(stats.wastedBytes == 0);
+	CHECK(stats.dedicatedBlockCount == 0);
+	CHECK(stats.freeRangeCount == stats.blockCount);
+	CHECK(stats.largestFreeRange == BLOCK_SIZE);
+}
+
+int main(int argc, char** argv) {
+	int operations = argc > 1 ? std::atoi(argv[1]) : 20000;
+	try {
+		testAlignment();
+		testGranularity();
+		testDedicatedThreshold();
+		testOutOfMemoryFallback();
+		testFreeAndCoalesce();
+		testMappingAndStats();
+		testRandom(operations);
+	} catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	if (failures > 0) {
+		std::cout << failures << " allocator checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "All allocator checks passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,200 @@
+//PipelineLibrary against a mock build function, no device needed. Checks that permutations build on the workers, that requests get the fallback
+//until update() publishes the build, that repeated requests share one build, that a failed build stays on the fallback and is never retried,
+//and that destruction waits for running builds and destroys every pipeline once. Exits with 1 if any check fails
+
+#include <vulkan/vulkan.h>
+
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtx/hash.hpp>
+
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <array>
+#include <optional>
+#include <unordered_map>
+#include <map>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <tuple>
+
+#include "../headers/structs.h"
+#include "../headers/hash.h"
+#include "../headers/pipelineKey.h"
+#include "../headers/assetLoader.h"
+#include "../headers/pipelineLibrary.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if (!(condition)) { std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << std::endl; failures++; } } while (0)
+
+//Hands out numbered handles once the gate is open, throws for keys with depth writes off. Counts builds per key and records destroyed handles
+struct MockCompiler {
+	std::mutex mutex;
+	std::condition_variable gateChanged;
+	bool open = false;
+	uint64_t nextHandle = 1;
+	std::map<std::string, int> builds;
+	std::vector<std::thread::id> buildThreads;
+	std::vector<VkPipeline> destroyed;
+
+	VkPipeline build(const PipelineKey& key) {
+		std::unique_lock<std::mutex> lock(mutex);
+		builds[key.vertexShader]++;
+		buildThreads.push_back(std::this_thread::get_id());
+		gateChanged.wait(lock, [this]() { return open; });
+		if (!key.depthWrite) { throw std::runtime_error("mock compile error"); }
+		return reinterpret_cast<VkPipeline>(static_cast<uintptr_t>(nextHandle++));
+	}
+
+	void setGate(bool value) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			open = value;
+		}
+		gateChanged.notify_all();
+	}
+
+	int buildCount(const std::string& vertexShader) {
+		std::lock_guard<std::mutex> lock(mutex);
+		return builds[vertexShader];
+	}
+};
+
+static PipelineKey makeKey(const std::string& vertexShader, bool depthWrite = true) {
+	PipelineKey key{};
+		key.vertexShader = vertexShader;
+		key.fragmentShader = "frag.spv";
+		key.vertexFormat = VertexFormat::Full;
+		key.instanced = false;
+		key.cullMode = VK_CULL_MODE_BACK_BIT;
+		key.alphaBlend = false;
+		key.depthTest = true;
+		key.depthWrite = depthWrite;
+		key.samples = VK_SAMPLE_COUNT_1_BIT;
+	return key;
+}
+
+//Runs update() until nothing is compiling, gives up after a few seconds
+static void updateUntilIdle(PipelineLibrary& library) {
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while (library.compiling() > 0 && std::chrono::steady_clock::now() < deadline) {
+		library.update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+static const VkPipeline fallback = reinterpret_cast<VkPipeline>(static_cast<uintptr_t>(1000));
+
+static void testPublish() {
+	MockCompiler mock;
+	{
+		PipelineLibrary library(2, [&mock](const PipelineKey& key) { return mock.build(key); }, [&mock](VkPipeline pipeline) { mock.destroyed.push_back(pipeline); },
+			makeKey("fallback"), fallback);
+		CHECK(library.size() == 1);
+		CHECK(library.request(makeKey("fallback")) == fallback);
+
+		//Pending builds draw with the fallback, repeated requests share the queued build
+		CHECK(library.request(makeKey("a")) == fallback);
+		CHECK(library.request(makeKey("b")) == fallback);
+		for (int i = 0; i < 100; i++) {
+			CHECK(library.request(makeKey("a")) == fallback);
+			library.update();
+		}
+		CHECK(library.compiling() == 2);
+		CHECK(library.size() == 3);
+		CHECK(library.update() == 0);
+
+		mock.setGate(true);
+		updateUntilIdle(library);
+		CHECK(library.compiling() == 0);
+		CHECK(library.failed() == 0);
+		CHECK(mock.buildCount("a") == 1);
+		CHECK(mock.buildCount("b") == 1);
+		CHECK(mock.buildCount("fallback") == 0);
+
+		VkPipeline a = library.request(makeKey("a"));
+		VkPipeline b = library.request(makeKey("b"));
+		CHECK(a != fallback && a != VK_NULL_HANDLE);
+		CHECK(b != fallback && b != VK_NULL_HANDLE && b != a);
+		CHECK(library.request(makeKey("a")) == a);
+
+		for (std::thread::id id : mock.buildThreads) { CHECK(id != std::this_thread::get_id()); }
+		CHECK(mock.destroyed.empty());
+	}
+	//The fallback and both permutations, once each
+	CHECK(mock.destroyed.size() == 3);
+	std::sort(mock.destroyed.begin(), mock.destroyed.end());
+	CHECK(std::adjacent_find(mock.destroyed.begin(), mock.destroyed.end()) == mock.destroyed.end());
+	CHECK(std::find(mock.destroyed.begin(), mock.destroyed.end(), fallback) != mock.destroyed.end());
+}
+
+static void testFailure() {
+	MockCompiler mock;
+	mock.setGate(true);
+	{
+		PipelineLibrary library(1, [&mock](const PipelineKey& key) { return mock.build(key); }, [&mock](VkPipeline pipeline) { mock.destroyed.push_back(pipeline); },
+			makeKey("fallback"), fallback);
+		CHECK(library.request(makeKey("broken", false)) == fallback);
+		updateUntilIdle(library);
+		CHECK(library.failed() == 1);
+
+		//Never retried, keeps the fallback
+		for (int i = 0; i < 10; i++) {
+			CHECK(library.request(makeKey("broken", false)) == fallback);
+			library.update();
+		}
+		CHECK(mock.buildCount("broken") == 1);
+		CHECK(library.compiling() == 0);
+		CHECK(library.failed() == 1);
+	}
+	CHECK(mock.destroyed.size() == 1);
+}
+
+static void testDestroyWhileCompiling() {
+	MockCompiler mock;
+	std::thread opener;
+	{
+		PipelineLibrary library(2, [&mock](const PipelineKey& key) { return mock.build(key); }, [&mock](VkPipeline pipeline) { mock.destroyed.push_back(pipeline); },
+			makeKey("fallback"), fallback);
+		for (int i = 0; i < 8; i++) { library.request(makeKey("pending" + std::to_string(i))); }
+		CHECK(library.compiling() == 8);
+
+		//Opens the gate while the destructor is already waiting on the builds
+		opener = std::thread([&mock]() {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			mock.setGate(true);
+		});
+	}
+	opener.join();
+	//Queued builds may be dropped, every one that ran is destroyed along with the fallback
+	int built = 0;
+	for (int i = 0; i < 8; i++) { built += mock.buildCount("pending" + std::to_string(i)); }
+	CHECK(mock.destroyed.size() == static_cast<size_t>(built) + 1);
+	CHECK(std::find(mock.destroyed.begin(), mock.destroyed.end(), VK_NULL_HANDLE) == mock.destroyed.end());
+}
+
+int main() {
+	testPublish();
+	testFailure();
+	testDestroyWhileCompiling();
+
+	if (failures > 0) {
+		std::cerr << failures << " pipeline library checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "All pipeline library checks passed" << std::endl;
+	return 0;
+}